@@ -36,6 +36,13 @@ public:
             // Set Less Than: Se acc < operand, retorna 1, senão 0
             return (accVal < operandVal) ? 1 : 0;
 
+        case InstructionType::PADDB:
+            return (int32_t)packedAdd((uint32_t)accVal, (uint32_t)operandVal);
+
+        case InstructionType::PXORB:
+            // XOR não tem vai-um: cada lane já é independente
+            return accVal ^ operandVal;
+
         case InstructionType::LOAD:
             // No caso de LOAD, a ULA apenas passa o valor do operando direto para o ACC
             // "ACC = 0 + Operando" ou apenas "ACC = Operando"
@@ -54,4 +61,19 @@ public:
             return accVal;
         }
     }
+
+    // SIMD dentro do registrador (SWAR): soma os 7 bits baixos de cada lane e
+    // recoloca o bit alto com XOR, para o vai-um não atravessar para a lane vizinha
+    static uint32_t packedAdd(uint32_t a, uint32_t b)
+    {
+        const uint32_t LOW7 = 0x7F7F7F7Fu;
+        const uint32_t HIGH = 0x80808080u;
+        return ((a & LOW7) + (b & LOW7)) ^ ((a ^ b) & HIGH);
+    }
+
+    // Imediato de 8 bits replicado nas 4 lanes
+    static uint32_t broadcastByte(uint32_t value)
+    {
+        return (value & 0xFFu) * 0x01010101u;
+    }
 };
\ No newline at end of file
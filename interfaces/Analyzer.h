@@ -0,0 +1,795 @@
+#pragma once
+#include "Types.h"
+#include "InstructionDecoder.h"
+#include "Dram.h"
+#include "CPU.h"
+#include "Colors.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Análise estática do firmware: CFG, laços e limite de pior caso (WCET).
+//
+//  - Rotinas: ponto de entrada, ISRs (vetor 1 em 500, vetor 2 em 700) e alvos de CALL.
+//  - CFG por rotina em blocos básicos (JUMP/JEQ/CALL/RET/HALT encerram o bloco).
+//  - Laços naturais por dominadores; cada um precisa de um limite de iterações
+//    (--bound CABECALHO=N), senão a rotina fica "ilimitada".
+//  - Cache: análise must/may (interpretação abstrata) com a geometria da Cache
+//    (mapeamento direto, write-through sem alocação na escrita). Acesso sempre
+//    hit (AH) não paga nada; sempre miss (AM) e não classificado (NC) pagam o
+//    pior preenchimento de linha da DRAM.
+//
+// Dois relógios: "clock" é o totalCycles do run sem modelo de tempo (1 por
+// instrução + latência das instruções de bloco); "total" soma a espera de memória.
+struct AnalyzerConfig
+{
+    size_t cacheLines = 8;
+    size_t wordsPerLine = 4;
+    Address ramSize = 1024;
+    DramConfig dram;
+    std::map<Address, unsigned long long> loopBounds; // Cabeçalho -> máx. de execuções do cabeçalho
+};
+
+// Custo de pior caso em um dos dois relógios
+struct WcetBound
+{
+    bool bounded = true;
+    unsigned long long clock = 0;
+    unsigned long long total = 0;
+};
+
+class WcetAnalyzer
+{
+public:
+    struct Loop
+    {
+        Address header;
+        size_t routine;
+        size_t blocks = 0;
+        unsigned long long bound = 0; // 0 = sem limite informado
+        bool hasExit = false;
+        WcetBound iteration;
+    };
+
+    struct Routine
+    {
+        std::string name;
+        Address entry;
+        int vector = 0; // 1/2 para ISRs
+        size_t blocks = 0;
+        size_t instructions = 0;
+        size_t alwaysHit = 0, alwaysMiss = 0, unclassified = 0;
+        unsigned long long maxInstructionClock = 0; // Maior instrução (atraso de IRQ)
+        std::vector<Address> calls;
+        std::string problem; // Motivo de ser ilimitada
+        WcetBound wcet;
+        bool done = false;
+    };
+
+private:
+    struct Block
+    {
+        Address start;
+        Address end; // Exclusivo
+        std::vector<size_t> succs;
+        std::vector<size_t> preds;
+    };
+
+    // Estado abstrato da cache (mapeamento direto: 1 bloco por conjunto)
+    struct CacheState
+    {
+        bool reached = false;
+        std::vector<int64_t> must;         // Bloco garantido no conjunto (-1 = nenhum)
+        std::vector<std::set<uint32_t>> may; // Blocos possíveis
+        std::vector<bool> mayAny;          // Qualquer bloco possível
+
+        bool operator==(const CacheState &other) const
+        {
+            return reached == other.reached && must == other.must && may == other.may && mayAny == other.mayAny;
+        }
+    };
+
+    enum class Access
+    {
+        HIT,
+        MISS,
+        UNCLASSIFIED
+    };
+
+    AnalyzerConfig config;
+    std::vector<Word> memory;
+    std::vector<Routine> routines;
+    std::vector<Loop> loops;
+    std::map<Address, size_t> routineAt;
+    std::set<Address> codeAddresses;
+    std::set<Address> selfModified;
+
+public:
+    explicit WcetAnalyzer(AnalyzerConfig cfg = AnalyzerConfig()) : config(cfg) {}
+
+    // 'image' é a RAM inicial (palavras a partir do endereço 0)
+    void analyze(const std::vector<Word> &image, Address entry)
+    {
+        memory = image;
+        memory.resize(std::max<size_t>(memory.size(), config.ramSize), 0);
+        routines.clear();
+        loops.clear();
+        routineAt.clear();
+        codeAddresses.clear();
+        selfModified.clear();
+
+        addRoutine("main", entry, 0);
+        if (isCode(500))
+            addRoutine("isr teclado", 500, IrqVector::KEYBOARD);
+        if (isCode(700))
+            addRoutine("isr falha pag.", 700, IrqVector::PAGE_FAULT);
+
+        // Descobre rotinas chamadas (a lista cresce durante o laço)
+        for (size_t r = 0; r < routines.size(); r++)
+            explore(r);
+
+        // STORE em endereço de código: o binário analisado não é o executado
+        for (Address pc : codeAddresses)
+        {
+            DecodedInstruction instr = InstructionDecoder::decode(memory[pc]);
+            if (static_cast<InstructionType>(instr.opcode) == InstructionType::STORE && codeAddresses.count(instr.operand))
+                selfModified.insert(instr.operand);
+        }
+
+        for (size_t r = 0; r < routines.size(); r++)
+            solve(r, 0);
+    }
+
+    const std::vector<Routine> &getRoutines() const { return routines; }
+    const std::vector<Loop> &getLoops() const { return loops; }
+
+    // Pior latência de IRQ: a instrução em curso termina, e uma ISR já em
+    // execução (interrupções desligadas até o RET) vai até o fim
+    WcetBound irqLatencyBound() const
+    {
+        WcetBound bound;
+        unsigned long long longestInstruction = 1;
+        for (const auto &routine : routines)
+            longestInstruction = std::max(longestInstruction, routine.maxInstructionClock);
+        bound.clock = bound.total = longestInstruction;
+        unsigned long long isrClock = 0, isrTotal = 0;
+        for (const auto &routine : routines)
+        {
+            if (routine.vector == 0)
+                continue;
+            if (!routine.wcet.bounded)
+                bound.bounded = false;
+            isrClock = std::max(isrClock, routine.wcet.clock);
+            isrTotal = std::max(isrTotal, routine.wcet.total);
+        }
+        bound.clock += isrClock;
+        bound.total += isrTotal + missPenalty(); // A própria busca da instrução interrompida
+        return bound;
+    }
+
+    unsigned int missPenalty() const { return burstCycles(config.wordsPerLine); }
+
+    void printReport() const
+    {
+        std::cout << "Cache: " << config.cacheLines << " linhas x " << config.wordsPerLine
+                  << " palavras (mapeamento direto, write-through), miss <= " << missPenalty() << " ciclos" << std::endl;
+        if (!selfModified.empty())
+        {
+            std::cout << Color::YELLOW << "[AVISO] Codigo automodificavel em";
+            for (Address addr : selfModified)
+                std::cout << " " << addr;
+            std::cout << ": os limites valem para o binario original." << Color::RESET << std::endl;
+        }
+
+        std::cout << "\n"
+                  << Color::BOLD << "--- Rotinas ---" << Color::RESET << std::endl;
+        std::cout << std::left << std::setw(16) << "rotina" << std::right << std::setw(8) << "entrada" << std::setw(8) << "blocos"
+                  << std::setw(7) << "instr" << std::setw(6) << "AH" << std::setw(6) << "AM" << std::setw(6) << "NC"
+                  << std::setw(13) << "WCET clock" << std::setw(13) << "WCET total" << std::endl;
+        for (const auto &routine : routines)
+        {
+            std::cout << std::left << std::setw(16) << routine.name << std::right << std::setw(8) << routine.entry
+                      << std::setw(8) << routine.blocks << std::setw(7) << routine.instructions << std::setw(6) << routine.alwaysHit
+                      << std::setw(6) << routine.alwaysMiss << std::setw(6) << routine.unclassified;
+            if (routine.wcet.bounded)
+                std::cout << std::setw(13) << routine.wcet.clock << std::setw(13) << routine.wcet.total << std::endl;
+            else
+                std::cout << Color::YELLOW << "   ilimitada (" << routine.problem << ")" << Color::RESET << std::endl;
+        }
+
+        if (!loops.empty())
+        {
+            std::cout << "\n"
+                      << Color::BOLD << "--- Lacos ---" << Color::RESET << std::endl;
+            for (const auto &loop : loops)
+            {
+                std::cout << "  cabecalho " << std::setw(5) << loop.header << "  " << std::left << std::setw(16)
+                          << routines[loop.routine].name << std::right << std::setw(3) << loop.blocks << " blocos  ";
+                if (!loop.hasExit)
+                    std::cout << "infinito" << std::endl;
+                else if (loop.bound == 0)
+                    std::cout << Color::YELLOW << "sem limite (use --bound " << loop.header << "=N)" << Color::RESET << std::endl;
+                else
+                    std::cout << "limite " << loop.bound << ", iteracao <= " << loop.iteration.clock << " clock / "
+                              << loop.iteration.total << " total" << std::endl;
+            }
+        }
+    }
+
+private:
+    bool isCode(Address addr) const { return addr < config.ramSize && memory[addr] != 0; }
+
+    static bool isTerminator(InstructionType type)
+    {
+        return type == InstructionType::JUMP || type == InstructionType::JEQ || type == InstructionType::CALL ||
+               type == InstructionType::RET || type == InstructionType::HALT;
+    }
+
+    static bool isBlockOp(InstructionType type)
+    {
+        return type == InstructionType::MEMCPY || type == InstructionType::MEMSET || type == InstructionType::MEMCMP;
+    }
+
+    // Mesma regra da CPU: estes não leem o operando como dado
+    static bool readsOperand(InstructionType type)
+    {
+        return !(type == InstructionType::STORE || type == InstructionType::JUMP || type == InstructionType::JEQ ||
+                 type == InstructionType::CALL || type == InstructionType::PUSH || type == InstructionType::HALT);
+    }
+
+    unsigned int burstCycles(size_t words) const
+    {
+        if (words == 0)
+            return 0;
+        return config.dram.tRP + config.dram.tRCD + config.dram.tCAS + (unsigned int)(words - 1) * config.dram.perWordCycles;
+    }
+
+    size_t addRoutine(const std::string &name, Address entry, int vector)
+    {
+        auto it = routineAt.find(entry);
+        if (it != routineAt.end())
+            return it->second;
+        Routine routine;
+        routine.name = name;
+        routine.entry = entry;
+        routine.vector = vector;
+        routineAt[entry] = routines.size();
+        routines.push_back(routine);
+        return routines.size() - 1;
+    }
+
+    // --- CFG ---
+
+    // Instruções alcançáveis a partir da entrada (sem entrar nos CALLs)
+    std::vector<Block> buildBlocks(size_t r)
+    {
+        std::set<Address> code, leaders;
+        std::vector<Address> work{routines[r].entry};
+        leaders.insert(routines[r].entry);
+        while (!work.empty())
+        {
+            Address pc = work.back();
+            work.pop_back();
+            if (pc >= config.ramSize || !code.insert(pc).second)
+                continue;
+            DecodedInstruction instr = InstructionDecoder::decode(memory[pc]);
+            InstructionType type = static_cast<InstructionType>(instr.opcode);
+            switch (type)
+            {
+            case InstructionType::HALT:
+            case InstructionType::RET:
+                break;
+            case InstructionType::JUMP:
+                leaders.insert(instr.operand);
+                work.push_back(instr.operand);
+                break;
+            case InstructionType::JEQ:
+                leaders.insert(instr.operand);
+                leaders.insert(pc + 1);
+                work.push_back(instr.operand);
+                work.push_back(pc + 1);
+                break;
+            case InstructionType::CALL:
+                leaders.insert(pc + 1);
+                work.push_back(pc + 1);
+                break;
+            default:
+                work.push_back(pc + 1);
+                break;
+            }
+        }
+        codeAddresses.insert(code.begin(), code.end());
+
+        std::vector<Block> blocks;
+        std::map<Address, size_t> blockAt;
+        for (Address leader : leaders)
+        {
+            if (!code.count(leader))
+                continue;
+            Block block{leader, leader, {}, {}};
+            Address pc = leader;
+            while (true)
+            {
+                InstructionType type = static_cast<InstructionType>(InstructionDecoder::decode(memory[pc]).opcode);
+                pc++;
+                if (isTerminator(type) || !code.count(pc) || leaders.count(pc))
+                    break;
+            }
+            block.end = pc;
+            blockAt[leader] = blocks.size();
+            blocks.push_back(block);
+        }
+
+        // Arestas (o bloco da entrada fica em primeiro)
+        std::stable_partition(blocks.begin(), blocks.end(), [&](const Block &b) { return b.start == routines[r].entry; });
+        for (size_t i = 0; i < blocks.size(); i++)
+            blockAt[blocks[i].start] = i;
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            Address last = blocks[i].end - 1;
+            DecodedInstruction instr = InstructionDecoder::decode(memory[last]);
+            InstructionType type = static_cast<InstructionType>(instr.opcode);
+            std::vector<Address> targets;
+            if (type == InstructionType::JUMP)
+                targets.push_back(instr.operand);
+            else if (type == InstructionType::JEQ)
+                targets = {instr.operand, last + 1};
+            else if (type != InstructionType::RET && type != InstructionType::HALT)
+                targets.push_back(last + 1);
+            for (Address target : targets)
+            {
+                auto it = blockAt.find(target);
+                if (it == blockAt.end())
+                    continue;
+                if (std::find(blocks[i].succs.begin(), blocks[i].succs.end(), it->second) == blocks[i].succs.end())
+                {
+                    blocks[i].succs.push_back(it->second);
+                    blocks[it->second].preds.push_back(i);
+                }
+            }
+        }
+        return blocks;
+    }
+
+    void explore(size_t r)
+    {
+        std::vector<Block> blocks = buildBlocks(r);
+        for (const Block &block : blocks)
+        {
+            for (Address pc = block.start; pc < block.end; pc++)
+            {
+                DecodedInstruction instr = InstructionDecoder::decode(memory[pc]);
+                if (static_cast<InstructionType>(instr.opcode) == InstructionType::CALL)
+                {
+                    addRoutine("sub " + std::to_string(instr.operand), instr.operand, 0);
+                    routines[r].calls.push_back(instr.operand);
+                }
+            }
+        }
+    }
+
+    // --- Cache abstrata ---
+
+    CacheState unknownCache() const
+    {
+        CacheState state;
+        state.reached = true;
+        state.must.assign(config.cacheLines, -1);
+        state.may.assign(config.cacheLines, std::set<uint32_t>());
+        state.mayAny.assign(config.cacheLines, true);
+        return state;
+    }
+
+    void join(CacheState &into, const CacheState &from) const
+    {
+        if (!from.reached)
+            return;
+        if (!into.reached)
+        {
+            into = from;
+            return;
+        }
+        for (size_t s = 0; s < config.cacheLines; s++)
+        {
+            if (into.must[s] != from.must[s])
+                into.must[s] = -1;
+            into.may[s].insert(from.may[s].begin(), from.may[s].end());
+            into.mayAny[s] = into.mayAny[s] || from.mayAny[s];
+        }
+    }
+
+    Access read(CacheState &state, Address addr) const
+    {
+        uint32_t block = addr / (uint32_t)config.wordsPerLine;
+        size_t set = block % config.cacheLines;
+        Access result = Access::UNCLASSIFIED;
+        if (state.must[set] == (int64_t)block)
+            result = Access::HIT;
+        else if (!state.mayAny[set] && !state.may[set].count(block))
+            result = Access::MISS;
+        state.must[set] = block;
+        state.may[set] = {block};
+        state.mayAny[set] = false;
+        return result;
+    }
+
+    // Leitura de endereço desconhecido (pilha): pode ter trocado qualquer linha
+    void readUnknown(CacheState &state) const
+    {
+        state.must.assign(config.cacheLines, -1);
+        state.mayAny.assign(config.cacheLines, true);
+    }
+
+    // Aplica uma instrução ao estado; devolve quantos acessos não são hit garantido
+    unsigned int transfer(CacheState &state, Address pc, Routine *counts) const
+    {
+        DecodedInstruction instr = InstructionDecoder::decode(memory[pc]);
+        InstructionType type = static_cast<InstructionType>(instr.opcode);
+        unsigned int misses = 0;
+        auto note = [&](Access access)
+        {
+            if (access != Access::HIT)
+                misses++;
+            if (counts)
+            {
+                if (access == Access::HIT)
+                    counts->alwaysHit++;
+                else if (access == Access::MISS)
+                    counts->alwaysMiss++;
+                else
+                    counts->unclassified++;
+            }
+        };
+
+        note(read(state, pc)); // Busca
+        if (readsOperand(type) && instr.isAddressMode && instr.operand < 0xE000)
+            note(read(state, instr.operand));
+        if (type == InstructionType::POP || type == InstructionType::RET)
+        {
+            readUnknown(state);
+            note(Access::UNCLASSIFIED);
+        }
+        if (type == InstructionType::CALL)
+            readUnknown(state); // A rotina chamada pode ter trocado qualquer linha
+        return misses;
+    }
+
+    // --- WCET ---
+
+    // Custo de uma instrução (sem a rotina chamada)
+    WcetBound instructionCost(Address pc, unsigned int misses) const
+    {
+        DecodedInstruction instr = InstructionDecoder::decode(memory[pc]);
+        InstructionType type = static_cast<InstructionType>(instr.opcode);
+        WcetBound cost;
+        cost.clock = 1;
+        unsigned long long memoryCycles = (unsigned long long)misses * missPenalty();
+        if (isBlockOp(type))
+        {
+            size_t count = instr.isAddressMode ? CPU::MAX_BLOCK_WORDS : std::min<size_t>(instr.operand, CPU::MAX_BLOCK_WORDS);
+            cost.clock = 1 + (count + CPU::BLOCK_WORDS_PER_CYCLE - 1) / CPU::BLOCK_WORDS_PER_CYCLE;
+            unsigned int bursts = (type == InstructionType::MEMSET) ? 1 : 2;
+            memoryCycles += (unsigned long long)bursts * burstCycles(count);
+        }
+        cost.total = cost.clock + memoryCycles;
+        return cost;
+    }
+
+    void solve(size_t r, int depth)
+    {
+        Routine &routine = routines[r];
+        if (routine.done)
+            return;
+        if (depth > (int)routines.size())
+        {
+            routine.wcet.bounded = false;
+            routine.problem = "recursao";
+            routine.done = true;
+            return;
+        }
+
+        // Rotinas chamadas primeiro
+        for (Address callee : routine.calls)
+        {
+            size_t c = routineAt[callee];
+            if (!routines[c].done)
+                solve(c, depth + 1);
+        }
+
+        std::vector<Block> blocks = buildBlocks(r);
+        routine.blocks = blocks.size();
+        for (const Block &block : blocks)
+            routine.instructions += block.end - block.start;
+
+        std::vector<size_t> order = reversePostorder(blocks);
+
+        // --- Cache must/may até o ponto fixo ---
+        std::vector<CacheState> in(blocks.size());
+        in[0] = unknownCache();
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t b : order)
+            {
+                CacheState merged = (b == 0) ? unknownCache() : CacheState();
+                for (size_t p : blocks[b].preds)
+                {
+                    if (!in[p].reached)
+                        continue;
+                    CacheState out = in[p];
+                    for (Address pc = blocks[p].start; pc < blocks[p].end; pc++)
+                        transfer(out, pc, nullptr);
+                    join(merged, out);
+                }
+                if (!(merged == in[b]))
+                {
+                    in[b] = merged;
+                    changed = true;
+                }
+            }
+        }
+
+        // Custo de cada bloco com a classificação final
+        std::vector<WcetBound> blockCost(blocks.size());
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            CacheState state = in[b].reached ? in[b] : unknownCache();
+            for (Address pc = blocks[b].start; pc < blocks[b].end; pc++)
+            {
+                WcetBound cost = instructionCost(pc, transfer(state, pc, &routine));
+                routine.maxInstructionClock = std::max(routine.maxInstructionClock, cost.clock);
+                DecodedInstruction instr = InstructionDecoder::decode(memory[pc]);
+                if (static_cast<InstructionType>(instr.opcode) == InstructionType::CALL)
+                {
+                    const Routine &callee = routines[routineAt[instr.operand]];
+                    if (!callee.wcet.bounded)
+                        markUnbounded(routine, "chama " + callee.name);
+                    cost.clock += callee.wcet.clock;
+                    cost.total += callee.wcet.total;
+                }
+                blockCost[b].clock += cost.clock;
+                blockCost[b].total += cost.total;
+            }
+        }
+
+        // --- Laços naturais ---
+        std::vector<size_t> idom = dominators(blocks, order);
+        std::map<size_t, std::set<size_t>> bodies; // Cabeçalho -> corpo
+        for (size_t u = 0; u < blocks.size(); u++)
+        {
+            for (size_t h : blocks[u].succs)
+            {
+                if (!dominates(idom, h, u))
+                    continue;
+                std::set<size_t> &body = bodies[h];
+                body.insert(h);
+                std::vector<size_t> work{u};
+                while (!work.empty())
+                {
+                    size_t n = work.back();
+                    work.pop_back();
+                    if (!body.insert(n).second)
+                        continue;
+                    for (size_t p : blocks[n].preds)
+                        work.push_back(p);
+                }
+            }
+        }
+
+        // Interno antes de externo
+        std::vector<std::pair<size_t, std::set<size_t>>> nest(bodies.begin(), bodies.end());
+        std::sort(nest.begin(), nest.end(), [](const auto &a, const auto &b) { return a.second.size() < b.second.size(); });
+
+        std::vector<WcetBound> loopCost(nest.size());
+        auto representative = [&](size_t b, size_t outer) -> size_t
+        {
+            // Laço mais externo, dentro da região 'outer', que contém b
+            size_t best = SIZE_MAX;
+            for (size_t l = 0; l < outer; l++)
+            {
+                if (nest[l].second.count(b) && (outer == nest.size() || nest[outer].second.count(nest[l].first)))
+                    best = l;
+            }
+            return best;
+        };
+
+        // Caminho mais longo dentro de uma região (corpo de um laço ou a rotina inteira),
+        // com os laços internos colapsados num só nó
+        auto regionLongest = [&](size_t regionIndex, bool total, bool &acyclic) -> unsigned long long
+        {
+            bool isLoop = regionIndex < nest.size();
+            size_t source = isLoop ? nest[regionIndex].first : 0;
+            auto inRegion = [&](size_t b) { return !isLoop || nest[regionIndex].second.count(b); };
+            auto nodeOf = [&](size_t b) -> std::pair<bool, size_t> // (é laço, índice)
+            {
+                size_t l = representative(b, regionIndex);
+                if (l != SIZE_MAX)
+                    return {true, l};
+                return {false, b};
+            };
+            auto cost = [&](std::pair<bool, size_t> node)
+            {
+                const WcetBound &c = node.first ? loopCost[node.second] : blockCost[node.second];
+                return total ? c.total : c.clock;
+            };
+            auto successors = [&](std::pair<bool, size_t> node)
+            {
+                std::vector<std::pair<bool, size_t>> out;
+                std::vector<size_t> members;
+                if (node.first)
+                    members.assign(nest[node.second].second.begin(), nest[node.second].second.end());
+                else
+                    members.push_back(node.second);
+                for (size_t m : members)
+                {
+                    for (size_t v : blocks[m].succs)
+                    {
+                        if (node.first && nest[node.second].second.count(v))
+                            continue; // Dentro do laço colapsado
+                        if (!inRegion(v) || (isLoop && v == source))
+                            continue; // Sai da região ou volta ao cabeçalho
+                        auto next = nodeOf(v);
+                        if (std::find(out.begin(), out.end(), next) == out.end())
+                            out.push_back(next);
+                    }
+                }
+                return out;
+            };
+
+            // Ordem topológica (DFS); ciclo que sobra = laço irredutível
+            std::map<std::pair<bool, size_t>, int> mark;
+            std::vector<std::pair<bool, size_t>> topo;
+            std::function<void(std::pair<bool, size_t>)> visit = [&](std::pair<bool, size_t> node)
+            {
+                mark[node] = 1;
+                for (auto next : successors(node))
+                {
+                    if (mark[next] == 1)
+                        acyclic = false;
+                    else if (mark[next] == 0)
+                        visit(next);
+                }
+                mark[node] = 2;
+                topo.push_back(node);
+            };
+            std::pair<bool, size_t> start = isLoop ? std::make_pair(false, source) : nodeOf(0);
+            visit(start);
+            std::reverse(topo.begin(), topo.end());
+
+            std::map<std::pair<bool, size_t>, unsigned long long> dist;
+            unsigned long long longest = 0;
+            for (auto node : topo)
+            {
+                unsigned long long here = dist[node] + cost(node);
+                longest = std::max(longest, here);
+                for (auto next : successors(node))
+                    dist[next] = std::max(dist[next], here);
+            }
+            return longest;
+        };
+
+        for (size_t l = 0; l < nest.size(); l++)
+        {
+            Loop loop;
+            loop.header = blocks[nest[l].first].start;
+            loop.routine = r;
+            loop.blocks = nest[l].second.size();
+            for (size_t b : nest[l].second)
+                for (size_t v : blocks[b].succs)
+                    loop.hasExit = loop.hasExit || !nest[l].second.count(v);
+            auto bound = config.loopBounds.find(loop.header);
+            if (bound != config.loopBounds.end())
+                loop.bound = bound->second;
+
+            bool acyclic = true;
+            loop.iteration.clock = regionLongest(l, false, acyclic);
+            loop.iteration.total = regionLongest(l, true, acyclic);
+            if (!acyclic)
+                markUnbounded(routine, "laco irredutivel");
+            if (!loop.hasExit)
+                markUnbounded(routine, "laco infinito em " + std::to_string(loop.header));
+            else if (loop.bound == 0)
+                markUnbounded(routine, "laco sem limite em " + std::to_string(loop.header));
+            loopCost[l].clock = loop.bound * loop.iteration.clock;
+            loopCost[l].total = loop.bound * loop.iteration.total;
+            loops.push_back(loop);
+        }
+
+        bool acyclic = true;
+        routine.wcet.clock = regionLongest(nest.size(), false, acyclic);
+        routine.wcet.total = regionLongest(nest.size(), true, acyclic);
+        if (!acyclic)
+            markUnbounded(routine, "laco irredutivel");
+        routine.done = true;
+    }
+
+    static void markUnbounded(Routine &routine, const std::string &reason)
+    {
+        if (routine.wcet.bounded)
+            routine.problem = reason;
+        routine.wcet.bounded = false;
+    }
+
+    static std::vector<size_t> reversePostorder(const std::vector<Block> &blocks)
+    {
+        std::vector<size_t> post;
+        std::vector<bool> seen(blocks.size(), false);
+        std::function<void(size_t)> visit = [&](size_t b)
+        {
+            seen[b] = true;
+            for (size_t s : blocks[b].succs)
+                if (!seen[s])
+                    visit(s);
+            post.push_back(b);
+        };
+        if (!blocks.empty())
+            visit(0);
+        std::reverse(post.begin(), post.end());
+        return post;
+    }
+
+    // Dominadores imediatos (Cooper, Harvey e Kennedy)
+    static std::vector<size_t> dominators(const std::vector<Block> &blocks, const std::vector<size_t> &order)
+    {
+        std::vector<size_t> position(blocks.size(), SIZE_MAX), idom(blocks.size(), SIZE_MAX);
+        for (size_t i = 0; i < order.size(); i++)
+            position[order[i]] = i;
+        if (blocks.empty())
+            return idom;
+        idom[0] = 0;
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t b : order)
+            {
+                if (b == 0)
+                    continue;
+                size_t next = SIZE_MAX;
+                for (size_t p : blocks[b].preds)
+                {
+                    if (idom[p] == SIZE_MAX)
+                        continue;
+                    if (next == SIZE_MAX)
+                    {
+                        next = p;
+                        continue;
+                    }
+                    size_t a = p, c = next;
+                    while (a != c)
+                    {
+                        while (position[a] > position[c])
+                            a = idom[a];
+                        while (position[c] > position[a])
+                            c = idom[c];
+                    }
+                    next = a;
+                }
+                if (next != idom[b])
+                {
+                    idom[b] = next;
+                    changed = true;
+                }
+            }
+        }
+        return idom;
+    }
+
+    static bool dominates(const std::vector<size_t> &idom, size_t a, size_t b)
+    {
+        while (true)
+        {
+            if (a == b)
+                return true;
+            if (b == 0 || idom[b] == SIZE_MAX)
+                return false;
+            b = idom[b];
+        }
+    }
+};
@@ -1,18 +1,96 @@
 #pragma once
 #include "Types.h"
+#include "Optimizer.h"
+#include "ObjectFile.h"
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <unordered_map>
 #include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <vector>
 
+// Tabela hash perfeita dos mnemônicos: h = (c0 + 2*c1 + 25*cN + tamanho) % 64
+// não colide para nenhum mnemônico (conferido pelo static_assert abaixo).
+// A busca custa um hash e uma comparação, sem alocar string.
+struct MnemonicTable
+{
+    static constexpr size_t SIZE = 64;
+
+    struct Entry
+    {
+        const char *name;
+        Opcode opcode;
+    };
+
+    static constexpr Entry MNEMONICS[] = {
+        {"HALT", 0x00}, {"LOAD", 0x01}, {"STORE", 0x02}, {"ADD", 0x03}, {"SUB", 0x04}, {"AND", 0x05}, {"XOR", 0x06}, {"SLT", 0x07}, {"JUMP", 0x08}, {"JEQ", 0x09}, {"PUSH", 0x0A}, {"POP", 0x0B}, {"CALL", 0x0C}, {"RET", 0x0D}, {"SETSRC", 0x0E}, {"SETDST", 0x0F}, {"MEMCPY", 0x10}, {"MEMSET", 0x11}, {"MEMCMP", 0x12}, {"PADDB", 0x13}, {"PXORB", 0x14}};
+
+    static constexpr size_t length(const char *s)
+    {
+        size_t n = 0;
+        while (s[n])
+            n++;
+        return n;
+    }
+
+    static constexpr size_t hash(const char *s, size_t len)
+    {
+        return ((unsigned char)s[0] + 2u * (unsigned char)s[1] + 25u * (unsigned char)s[len - 1] + len) % SIZE;
+    }
+
+    static constexpr bool collisionFree()
+    {
+        bool used[SIZE] = {};
+        for (const Entry &e : MNEMONICS)
+        {
+            size_t h = hash(e.name, length(e.name));
+            if (used[h])
+                return false;
+            used[h] = true;
+        }
+        return true;
+    }
+
+    // Retorna -1 se não for mnemônico (aceita minúsculas, como o montador antigo)
+    static int lookup(std::string_view word)
+    {
+        static const Table table;
+        if (word.size() < 3 || word.size() > 6)
+            return -1;
+        char upper[6];
+        for (size_t i = 0; i < word.size(); i++)
+            upper[i] = (char)::toupper((unsigned char)word[i]);
+        const Entry *e = table.slots[hash(upper, word.size())];
+        if (!e || std::string_view(e->name) != std::string_view(upper, word.size()))
+            return -1;
+        return e->opcode;
+    }
+
+private:
+    struct Table
+    {
+        const Entry *slots[SIZE] = {};
+        Table()
+        {
+            for (const Entry &e : MNEMONICS)
+                slots[hash(e.name, length(e.name))] = &e;
+        }
+    };
+};
+static_assert(MnemonicTable::collisionFree(), "hash dos mnemônicos colidiu: ajuste os coeficientes");
+
 class Assembler
 {
 private:
     std::unordered_map<std::string, Opcode> opcodes;
     std::unordered_map<std::string, Address> symbolTable;
 
+    // Passo -O opcional (peephole + código morto) antes da resolução dos labels
+    bool optimizeEnabled = false;
+    PeepholeOptimizer optimizer;
+
 public:
     Assembler()
     {
@@ -30,8 +108,18 @@ public:
         opcodes["POP"] = (Opcode)InstructionType::POP;
         opcodes["CALL"] = (Opcode)InstructionType::CALL;
         opcodes["RET"] = (Opcode)InstructionType::RET;
+        opcodes["SETSRC"] = (Opcode)InstructionType::SETSRC;
+        opcodes["SETDST"] = (Opcode)InstructionType::SETDST;
+        opcodes["MEMCPY"] = (Opcode)InstructionType::MEMCPY;
+        opcodes["MEMSET"] = (Opcode)InstructionType::MEMSET;
+        opcodes["MEMCMP"] = (Opcode)InstructionType::MEMCMP;
+        opcodes["PADDB"] = (Opcode)InstructionType::PADDB;
+        opcodes["PXORB"] = (Opcode)InstructionType::PXORB;
     }
 
+    void setOptimize(bool enabled) { optimizeEnabled = enabled; }
+    const OptimizerReport &getOptimizerReport() const { return optimizer.getReport(); }
+
     std::string cleanLine(std::string line)
     {
         size_t commentPos = line.find(';');
@@ -59,6 +147,10 @@ public:
                 cleanLines.push_back(clean);
         }
 
+        // -O: reescreve o fonte; os endereços são refeitos pelo passo 1
+        if (optimizeEnabled)
+            cleanLines = optimizer.optimize(cleanLines);
+
         // --- PASSO 1: Mapear Labels (Considerando ORG) ---
         Address currentAddress = 0;
         for (const auto &line : cleanLines)
@@ -121,6 +213,96 @@ public:
         return binaryProgram;
     }
 
+    // --- Montador de Passo Único ---
+    // Percorre o fonte (tipicamente mapeado com mmap) uma vez só, com
+    // string_view e from_chars: nenhuma linha é copiada. Toda referência a
+    // label vira pendência e é corrigida (backpatch) no fim, então um label
+    // duplicado vale pela última definição em todo o programa, como no
+    // assembleProgram. Gera o mesmo binário que ele (sem -O).
+    std::vector<Word> assembleSource(std::string_view source)
+    {
+        struct Fixup
+        {
+            size_t index; // Palavra do binário a corrigir
+            std::string_view label;
+        };
+
+        std::vector<Word> binary;
+        binary.reserve(source.size() / 8);
+        std::unordered_map<std::string_view, Address> labels;
+        std::vector<Fixup> fixups;
+
+        scan(
+            source,
+            [&](Address target)
+            {
+                if (binary.size() < target)
+                    binary.resize(target, 0); // 0 = HALT/NOP
+            },
+            [&](std::string_view label)
+            {
+                auto inserted = labels.emplace(label, (Address)binary.size());
+                if (!inserted.second)
+                {
+                    std::cerr << "[Assembler Warning] Label duplicado: " << label << " (vale a ultima definicao)" << std::endl;
+                    inserted.first->second = (Address)binary.size();
+                }
+            },
+            [&](Word machineCode, std::string_view labelOperand)
+            {
+                if (!labelOperand.empty())
+                    fixups.push_back({binary.size(), labelOperand});
+                binary.push_back(machineCode);
+            });
+
+        // Backpatch de todas as referências, já com a tabela completa
+        for (const Fixup &fixup : fixups)
+        {
+            auto it = labels.find(fixup.label);
+            if (it == labels.end())
+            {
+                std::cerr << "[Assembler Error] Label nao encontrado: " << fixup.label << std::endl;
+                continue;
+            }
+            binary[fixup.index] |= (it->second & 0x7FFFFF);
+        }
+        return binary;
+    }
+
+    // Mesmo passo único, mas gera um objeto relocável para o linker:
+    // cada ORG abre uma seção absoluta e todo operando com label vira relocação.
+    ObjectFile assembleObject(std::string_view source)
+    {
+        ObjectFile object;
+        object.sections.emplace_back(); // Seção relocável inicial
+
+        scan(
+            source,
+            [&](Address target)
+            {
+                ObjectSection section;
+                section.absolute = true;
+                section.org = target;
+                object.sections.push_back(section);
+            },
+            [&](std::string_view label)
+            {
+                uint32_t section = (uint32_t)object.sections.size() - 1;
+                object.symbols.push_back({std::string(label), section, (uint32_t)object.sections.back().words.size()});
+            },
+            [&](Word machineCode, std::string_view labelOperand)
+            {
+                ObjectSection &section = object.sections.back();
+                if (!labelOperand.empty())
+                {
+                    uint32_t index = (uint32_t)object.sections.size() - 1;
+                    object.relocations.push_back({index, (uint32_t)section.words.size(), std::string(labelOperand)});
+                }
+                section.words.push_back(machineCode);
+            });
+        return object;
+    }
+
     Word assembleLine(std::string line)
     {
         std::stringstream ss(line);
@@ -190,4 +372,111 @@ public:
 
         return machineCode;
     }
+
+private:
+    // Laço comum do passo único. Chama onOrg(endereço), onLabel(nome) e
+    // onInstruction(palavra, label do operando ou vazio) na ordem do fonte.
+    template <typename OnOrg, typename OnLabel, typename OnInstruction>
+    static void scan(std::string_view source, OnOrg &&onOrg, OnLabel &&onLabel, OnInstruction &&onInstruction)
+    {
+        size_t pos = 0;
+        while (pos < source.size())
+        {
+            size_t eol = source.find('\n', pos);
+            if (eol == std::string_view::npos)
+                eol = source.size();
+            std::string_view line = source.substr(pos, eol - pos);
+            pos = eol + 1;
+
+            // Comentário e espaços (mesma regra do cleanLine)
+            size_t comment = line.find(';');
+            if (comment != std::string_view::npos)
+                line = line.substr(0, comment);
+            line = trim(line);
+            if (line.empty())
+                continue;
+
+            if (line.substr(0, 3) == "ORG")
+            {
+                Address target = 0;
+                std::string_view digits = trim(line.substr(std::min<size_t>(4, line.size())));
+                std::from_chars(digits.data(), digits.data() + digits.size(), target);
+                onOrg(target);
+                continue;
+            }
+
+            if (line.back() == ':')
+            {
+                onLabel(line.substr(0, line.size() - 1));
+                continue;
+            }
+
+            // Mnemônico e operando (tokens extras são ignorados)
+            size_t split = line.find_first_of(" \t");
+            std::string_view mnemonic = line.substr(0, split);
+            std::string_view operand;
+            if (split != std::string_view::npos)
+            {
+                operand = trim(line.substr(split));
+                operand = operand.substr(0, operand.find_first_of(" \t"));
+            }
+
+            int op = MnemonicTable::lookup(mnemonic);
+            if (op < 0)
+            {
+                std::cerr << "[Assembler Error] Instrução desconhecida: " << mnemonic << std::endl;
+                onInstruction(0, std::string_view());
+                continue;
+            }
+            if (op == (Opcode)InstructionType::HALT)
+            {
+                onInstruction((Word)op << 24, std::string_view());
+                continue;
+            }
+
+            bool isImmediate = false;
+            uint32_t operandValue = 0;
+            std::string_view labelOperand;
+            if (!operand.empty())
+            {
+                if (operand[0] == '#')
+                {
+                    isImmediate = true;
+                    operandValue = parseInt(operand.substr(1));
+                }
+                else if (isdigit((unsigned char)operand[0]))
+                {
+                    operandValue = parseInt(operand);
+                }
+                else
+                {
+                    labelOperand = operand;
+                }
+            }
+
+            Word machineCode = ((Word)op << 24);
+            if (!isImmediate)
+                machineCode |= (1 << 23);
+            machineCode |= (operandValue & 0x7FFFFF);
+            onInstruction(machineCode, labelOperand);
+        }
+    }
+
+    static std::string_view trim(std::string_view text)
+    {
+        const char *whitespace = " \t\r\n";
+        size_t start = text.find_first_not_of(whitespace);
+        if (start == std::string_view::npos)
+            return std::string_view();
+        size_t end = text.find_last_not_of(whitespace);
+        return text.substr(start, end - start + 1);
+    }
+
+    // Como std::stoi: aceita sinal e para no primeiro caractere não numérico
+    static uint32_t parseInt(std::string_view text)
+    {
+        int32_t value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return (uint32_t)value;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,265 @@
+#pragma once
+#include "Types.h"
+#include "TimingModel.h"
+#include "Stats.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// --- Preditores de Direção (plugáveis) ---
+// Só decidem "tomado ou não". O destino vem do BTB / RAS.
+class BranchPredictor
+{
+public:
+    virtual ~BranchPredictor() = default;
+    virtual std::string name() const = 0;
+    virtual bool predict(Address pc) = 0;
+    virtual void update(Address pc, bool taken) = 0;
+};
+
+// Estático: sempre a mesma resposta (padrão: não-tomado, como o pipeline base)
+class StaticPredictor : public BranchPredictor
+{
+private:
+    bool alwaysTaken;
+
+public:
+    StaticPredictor(bool taken = false) : alwaysTaken(taken) {}
+    std::string name() const override { return alwaysTaken ? "static-taken" : "static-not-taken"; }
+    bool predict(Address) override { return alwaysTaken; }
+    void update(Address, bool) override {}
+};
+
+// Contador saturante de 2 bits (0,1 = não-tomado / 2,3 = tomado)
+struct SaturatingCounter
+{
+    uint8_t value = 1;
+    bool taken() const { return value >= 2; }
+    void train(bool outcome)
+    {
+        if (outcome && value < 3)
+            value++;
+        else if (!outcome && value > 0)
+            value--;
+    }
+};
+
+// Bimodal: tabela de contadores indexada pelo PC
+class BimodalPredictor : public BranchPredictor
+{
+private:
+    std::vector<SaturatingCounter> table;
+
+public:
+    BimodalPredictor(size_t entries = 256) : table(entries) {}
+    std::string name() const override { return "bimodal"; }
+    bool predict(Address pc) override { return table[pc % table.size()].taken(); }
+    void update(Address pc, bool taken) override { table[pc % table.size()].train(taken); }
+};
+
+// Gshare: PC XOR histórico global indexa a tabela de contadores
+class GsharePredictor : public BranchPredictor
+{
+private:
+    std::vector<SaturatingCounter> table;
+    uint32_t history = 0;
+    uint32_t historyMask;
+
+public:
+    GsharePredictor(size_t entries = 256, unsigned int historyBits = 8)
+        : table(entries), historyMask((1u << historyBits) - 1) {}
+
+    std::string name() const override { return "gshare"; }
+
+    bool predict(Address pc) override { return table[index(pc)].taken(); }
+
+    void update(Address pc, bool taken) override
+    {
+        table[index(pc)].train(taken);
+        history = ((history << 1) | (taken ? 1 : 0)) & historyMask;
+    }
+
+private:
+    size_t index(Address pc) const { return (pc ^ history) % table.size(); }
+};
+
+// Torneio: um seletor por PC escolhe entre bimodal (local) e gshare (global)
+class TournamentPredictor : public BranchPredictor
+{
+private:
+    BimodalPredictor bimodal;
+    GsharePredictor gshare;
+    std::vector<SaturatingCounter> chooser; // >= 2 -> confia no gshare
+
+public:
+    TournamentPredictor(size_t entries = 256) : bimodal(entries), gshare(entries), chooser(entries) {}
+
+    std::string name() const override { return "tournament"; }
+
+    bool predict(Address pc) override
+    {
+        return chooser[pc % chooser.size()].taken() ? gshare.predict(pc) : bimodal.predict(pc);
+    }
+
+    void update(Address pc, bool taken) override
+    {
+        bool localOk = (bimodal.predict(pc) == taken);
+        bool globalOk = (gshare.predict(pc) == taken);
+        if (localOk != globalOk)
+            chooser[pc % chooser.size()].train(globalOk);
+        bimodal.update(pc, taken);
+        gshare.update(pc, taken);
+    }
+};
+
+// --- Branch Target Buffer (mapeamento direto) ---
+class BranchTargetBuffer
+{
+private:
+    struct Entry
+    {
+        bool valid = false;
+        Address pc = 0;
+        Address target = 0;
+    };
+    std::vector<Entry> entries;
+
+public:
+    BranchTargetBuffer(size_t size = 16) : entries(size) {}
+
+    bool lookup(Address pc, Address &target) const
+    {
+        const Entry &e = entries[pc % entries.size()];
+        if (!e.valid || e.pc != pc)
+            return false;
+        target = e.target;
+        return true;
+    }
+
+    void update(Address pc, Address target)
+    {
+        Entry &e = entries[pc % entries.size()];
+        e.valid = true;
+        e.pc = pc;
+        e.target = target;
+    }
+};
+
+// --- Return Address Stack (circular: estoura sobrescrevendo o mais antigo) ---
+class ReturnAddressStack
+{
+private:
+    std::vector<Address> stack;
+    size_t top = 0;   // Próxima posição livre
+    size_t count = 0; // Entradas válidas
+
+public:
+    ReturnAddressStack(size_t depth = 8) : stack(depth) {}
+
+    void push(Address addr)
+    {
+        stack[top] = addr;
+        top = (top + 1) % stack.size();
+        if (count < stack.size())
+            count++;
+    }
+
+    bool pop(Address &addr)
+    {
+        if (count == 0)
+            return false;
+        top = (top + stack.size() - 1) % stack.size();
+        count--;
+        addr = stack[top];
+        return true;
+    }
+};
+
+// Junta direção + BTB + RAS e devolve a penalidade de cada desvio.
+// As penalidades seguem o estágio em que o pipeline descobre o erro:
+// destino direto conhecido no ID (1), JEQ resolvido no EX (2), RET no MEM (3).
+class BranchUnit
+{
+private:
+    std::unique_ptr<BranchPredictor> direction;
+    BranchTargetBuffer btb;
+    ReturnAddressStack ras;
+    Stats *stats;
+
+public:
+    BranchUnit(BranchPredictor *predictor, Stats *s, size_t btbEntries = 16, size_t rasDepth = 8)
+        : direction(predictor), btb(btbEntries), ras(rasDepth), stats(s) {}
+
+    std::string name() const { return direction->name(); }
+
+    unsigned int resolve(const RetiredInstruction &instr)
+    {
+        // A entrada numa ISR termina com RET: empilha o endereço de retorno
+        if (instr.irqEntry)
+            ras.push(instr.irqReturn);
+
+        unsigned int penalty = 0;
+        bool mispredicted = false;
+        Address target = 0;
+
+        switch (instr.type)
+        {
+        case InstructionType::JEQ:
+        {
+            bool predictedTaken = direction->predict(instr.pc);
+            direction->update(instr.pc, instr.branchTaken);
+            if (predictedTaken != instr.branchTaken)
+            {
+                penalty = 2;
+                mispredicted = true;
+            }
+            else if (instr.branchTaken && !(btb.lookup(instr.pc, target) && target == instr.nextPC))
+            {
+                penalty = 1; // Direção certa, mas o destino só sai no ID
+            }
+            if (instr.branchTaken)
+                btb.update(instr.pc, instr.nextPC);
+            break;
+        }
+
+        case InstructionType::JUMP:
+        case InstructionType::CALL:
+            if (!(btb.lookup(instr.pc, target) && target == instr.nextPC))
+            {
+                penalty = 1;
+                mispredicted = true;
+            }
+            btb.update(instr.pc, instr.nextPC);
+            if (instr.type == InstructionType::CALL)
+                ras.push(instr.pc + 1);
+            break;
+
+        case InstructionType::RET:
+            if (!(ras.pop(target) && target == instr.nextPC))
+            {
+                penalty = 3;
+                mispredicted = true;
+            }
+            break;
+
+        default:
+            return 0;
+        }
+
+        if (stats)
+        {
+            stats->branchCount++;
+            BranchSiteStats &site = stats->branchSites[instr.pc];
+            site.executed++;
+            if (instr.branchTaken)
+                site.taken++;
+            if (mispredicted)
+            {
+                stats->branchMispredicts++;
+                site.mispredicted++;
+            }
+            stats->branchPenaltyCycles += penalty;
+        }
+        return penalty;
+    }
+};
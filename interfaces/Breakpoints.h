@@ -0,0 +1,180 @@
+#pragma once
+#include "Types.h"
+#include "Registers.h"
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Condição opcional de um breakpoint: <registrador> <op> <valor>
+struct BreakCondition
+{
+    enum Reg
+    {
+        ALWAYS,
+        ACC,
+        SP
+    } reg = ALWAYS;
+    enum Op
+    {
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE
+    } op = EQ;
+    int32_t value = 0;
+
+    bool test(const Registers &r) const
+    {
+        if (reg == ALWAYS)
+            return true;
+        int32_t v = reg == ACC ? r.getACC() : (int32_t)r.getSP();
+        switch (op)
+        {
+        case EQ:
+            return v == value;
+        case NE:
+            return v != value;
+        case LT:
+            return v < value;
+        case LE:
+            return v <= value;
+        case GT:
+            return v > value;
+        default:
+            return v >= value;
+        }
+    }
+
+    // "acc == 3", "sp < 0x380"
+    static bool parse(const std::string &text, BreakCondition &out)
+    {
+        std::istringstream in(text);
+        std::string name, op, number;
+        if (!(in >> name >> op >> number))
+            return false;
+        if (name == "acc")
+            out.reg = ACC;
+        else if (name == "sp")
+            out.reg = SP;
+        else
+            return false;
+
+        static const char *OPS[] = {"==", "!=", "<", "<=", ">", ">="};
+        size_t i = 0;
+        while (i < 6 && op != OPS[i])
+            i++;
+        if (i == 6)
+            return false;
+        out.op = (Op)i;
+
+        char *end = nullptr;
+        out.value = (int32_t)std::strtol(number.c_str(), &end, 0);
+        return *end == '\0';
+    }
+
+    std::string text() const
+    {
+        static const char *OPS[] = {"==", "!=", "<", "<=", ">", ">="};
+        if (reg == ALWAYS)
+            return "";
+        return std::string(reg == ACC ? "acc " : "sp ") + OPS[op] + " " + std::to_string(value);
+    }
+};
+
+// Breakpoints de PC (com ou sem condição) e condições em qualquer PC.
+// O motor de depuração da CPU chama operator() antes de cada busca; um bit
+// por endereço descarta quase todos os PCs sem olhar a lista.
+class BreakpointSet
+{
+public:
+    static constexpr Address ANY_PC = ~0u; // Condição checada em todo passo
+
+    struct Breakpoint
+    {
+        int id;
+        Address pc;
+        BreakCondition condition;
+        unsigned long long hits = 0;
+    };
+
+private:
+    static constexpr size_t PC_SPACE = 1u << 16;
+
+    std::vector<uint64_t> pcBits = std::vector<uint64_t>(PC_SPACE / 64, 0);
+    std::vector<Breakpoint> list;
+    size_t anyPcCount = 0;
+    int nextId = 1;
+    int hitId = 0;
+
+public:
+    bool empty() const { return list.empty(); }
+    const std::vector<Breakpoint> &all() const { return list; }
+
+    int add(Address pc, const BreakCondition &condition = BreakCondition())
+    {
+        list.push_back({nextId, pc, condition});
+        rebuild();
+        return nextId++;
+    }
+
+    bool remove(int id)
+    {
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            if (list[i].id == id)
+            {
+                list.erase(list.begin() + i);
+                rebuild();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Id do último breakpoint que parou a CPU
+    int lastHit() const { return hitId; }
+    const Breakpoint *find(int id) const
+    {
+        for (const Breakpoint &bp : list)
+        {
+            if (bp.id == id)
+                return &bp;
+        }
+        return nullptr;
+    }
+
+    bool operator()(const Registers &r)
+    {
+        Address pc = r.getPC();
+        if (anyPcCount == 0 && (pc >= PC_SPACE || !(pcBits[pc >> 6] & (1ULL << (pc & 63)))))
+            return false;
+        for (Breakpoint &bp : list)
+        {
+            if ((bp.pc == pc || bp.pc == ANY_PC) && bp.condition.test(r))
+            {
+                bp.hits++;
+                hitId = bp.id;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    void rebuild()
+    {
+        std::fill(pcBits.begin(), pcBits.end(), 0);
+        anyPcCount = 0;
+        for (const Breakpoint &bp : list)
+        {
+            if (bp.pc == ANY_PC || bp.pc >= PC_SPACE)
+                anyPcCount++;
+            else
+                pcBits[bp.pc >> 6] |= 1ULL << (bp.pc & 63);
+        }
+    }
+};
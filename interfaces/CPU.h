@@ -7,7 +7,13 @@
 #include "PIC.h"
 #include "Stats.h"  // Necessário para métricas
 #include "Colors.h" // Necessário para logs coloridos
+#include "Trace.h"  // Eventos de IRQ vão para o trace binário
+#include "TimingModel.h"
+#include "Mmu.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 class CPU
 {
@@ -15,16 +21,49 @@ private:
     Registers registers;
     ALU alu;
     IMemoryDevice *bus;
+    IMemoryDevice *fetchBus; // Busca de instrução (não passa pelos watchpoints)
     PIC *pic;
     Stats *stats; // Ponteiro para o coletor de estatísticas
+    Tracer *tracer; // Trace binário (nullptr = sem logs)
 
     bool interruptsEnabled;
     bool halted;
 
+    // Endereço da instrução em execução (o PC já avançou após o fetch)
+    Address instructionPC = 0;
+
+    // Modelo de tempo opcional (pipeline, OoO...) alimentado pelo retire trace
+    ITimingModel *timingModel = nullptr;
+    RetiredInstruction retired;
+
+    // MMU opcional: numa falha de página a instrução é abortada e reiniciada
+    Mmu *mmu = nullptr;
+
+    // ISRs em andamento (duração entrada -> RET); CALLs dentro da ISR não contam como saída
+    struct IsrFrame
+    {
+        unsigned long long entryCycle;
+        unsigned int callDepth;
+    };
+    std::vector<IsrFrame> isrFrames;
+
+    // Passo interrompido pelo stepBefore: a busca ainda não aconteceu
+    bool fetchPending = false;
+    unsigned long long waitBefore = 0;
+    unsigned long long waitAfterIrq = 0;
+
+    // Operações em bloco: buffers reaproveitados
+    std::vector<Word> blockBuffer;
+    std::vector<Word> compareBuffer;
+
 public:
-    // Construtor Atualizado: Recebe Stats*
-    CPU(IMemoryDevice *memoryBus, PIC *interruptController, Stats *systemStats)
-        : bus(memoryBus), pic(interruptController), stats(systemStats), halted(false)
+    // Datapath de bloco: 4 palavras por ciclo (também usado pela análise de WCET)
+    static constexpr size_t BLOCK_WORDS_PER_CYCLE = 4;
+    static constexpr size_t MAX_BLOCK_WORDS = 4096;
+
+    // Construtor Atualizado: Recebe Stats* e, opcionalmente, o Tracer
+    CPU(IMemoryDevice *memoryBus, PIC *interruptController, Stats *systemStats, Tracer *systemTracer = nullptr)
+        : bus(memoryBus), fetchBus(memoryBus), pic(interruptController), stats(systemStats), tracer(systemTracer), halted(false)
     {
         registers.reset();
         interruptsEnabled = true; // Começa ouvindo interrupções
@@ -35,6 +74,9 @@ public:
     {
         // 1. Escreve no endereço atual do SP
         bus->write(registers.getSP(), value);
+        // Falha de página: o SP fica intacto para a instrução ser reexecutada
+        if (faulted())
+            return;
         // 2. Decrementa o SP (Pilha cresce para baixo: 1023 -> 1022)
         registers.decSP();
     }
@@ -44,32 +86,86 @@ public:
         // 1. Incrementa o SP (Volta para o último dado válido)
         registers.incSP();
         // 2. Lê o valor
-        return bus->read(registers.getSP());
+        Word value = bus->read(registers.getSP());
+        // Falha de página: desfaz o incremento
+        if (faulted())
+            registers.decSP();
+        return value;
     }
 
     // --- Ciclo Principal ---
-    void step()
+    void step() { stepImpl<false>(NoStop()); }
+
+    // Motor de depuração: como step(), mas consulta shouldStop(registers) antes
+    // da busca (já depois de uma eventual entrada em ISR). Retorna true se
+    // parou; o próximo passo continua do mesmo ponto, sem repetir a checagem
+    // de interrupções nem a consulta. O step() normal não paga nada disso.
+    template <typename StopCheck>
+    bool stepUntil(StopCheck &&shouldStop) { return stepImpl<true>(shouldStop); }
+
+    bool stepBefore(Address stopPC)
     {
-        if (halted)
-            return;
+        return stepUntil([stopPC](const Registers &r)
+                         { return r.getPC() == stopPC; });
+    }
 
-        // 1. CHECAGEM DE INTERRUPÇÃO
-        checkInterrupts();
+    // Parado entre a checagem de interrupções e a busca (ver stepBefore)
+    bool isFetchPending() const { return fetchPending; }
 
-        // 2. FETCH (Busca)
-        fetch();
+    // Estado arquitetural e de controle (checkpoints da viagem no tempo)
+    struct State
+    {
+        Registers registers;
+        bool interruptsEnabled;
+        bool halted;
+        bool fetchPending;
+        Address instructionPC;
+        RetiredInstruction retired;
+        std::vector<IsrFrame> isrFrames;
+        unsigned long long waitBefore;
+        unsigned long long waitAfterIrq;
+    };
+
+    State saveState() const
+    {
+        return {registers, interruptsEnabled, halted, fetchPending, instructionPC, retired, isrFrames, waitBefore, waitAfterIrq};
+    }
 
-        // [METRICA] Contabiliza Instrução Executada (IPC)
-        if (stats)
-            stats->totalInstructions++;
+    void restoreState(const State &s)
+    {
+        registers = s.registers;
+        interruptsEnabled = s.interruptsEnabled;
+        halted = s.halted;
+        fetchPending = s.fetchPending;
+        instructionPC = s.instructionPC;
+        retired = s.retired;
+        isrFrames = s.isrFrames;
+        waitBefore = s.waitBefore;
+        waitAfterIrq = s.waitAfterIrq;
+    }
 
-        // 3. DECODE (Decodificação)
-        DecodedInstruction decoded = decode();
+    // Troca o barramento visto pela CPU (ex.: MMU), na busca e nos dados
+    void setBus(IMemoryDevice *memoryBus) { bus = fetchBus = memoryBus; }
 
-        // 4. EXECUTE (Execução)
-        execute(decoded);
+    // Troca só o caminho dos dados (camada de watchpoints): a busca continua
+    // direto, senão um watch de leitura sobre o código dispararia a cada instrução
+    void setDataBus(IMemoryDevice *memoryBus) { bus = memoryBus; }
+
+    // Liga um modelo de tempo: a partir daí ele avança stats->totalCycles
+    void setTimingModel(ITimingModel *model) { timingModel = model; }
+    ITimingModel *getTimingModel() const { return timingModel; }
+
+    // Liga a MMU (o barramento da CPU deve ser a própria MMU)
+    void setMmu(Mmu *unit)
+    {
+        mmu = unit;
+        if (mmu)
+            mmu->setRegisters(&registers);
     }
 
+    // Ponto de entrada do firmware (cabeçalho da imagem)
+    void setEntryPoint(Address addr) { registers.setPC(addr); }
+
     void run()
     {
         while (!halted)
@@ -82,12 +178,96 @@ public:
 
     const Registers &getRegisters() const { return registers; }
 
+    // Usado por quem precisa saber qual instrução gerou um acesso (prefetch de stride)
+    const Address *getInstructionPCRef() const { return &instructionPC; }
+
 private:
+    struct NoStop
+    {
+        bool operator()(const Registers &) const { return false; }
+    };
+
+    template <bool CheckStop, typename StopCheck>
+    bool stepImpl(StopCheck &&shouldStop)
+    {
+        if (halted)
+            return false;
+
+        bool resumed = fetchPending;
+        if (!resumed)
+        {
+            retired = RetiredInstruction();
+            waitBefore = stats ? stats->busWaitCycles : 0;
+
+            // 1. CHECAGEM DE INTERRUPÇÃO
+            checkInterrupts();
+            waitAfterIrq = stats ? stats->busWaitCycles : 0;
+        }
+        fetchPending = false;
+        if (CheckStop && !resumed && shouldStop(registers))
+        {
+            fetchPending = true;
+            return true;
+        }
+
+        // 2. FETCH (Busca)
+        fetch();
+        unsigned long long waitAfterFetch = stats ? stats->busWaitCycles : 0;
+
+        // Falha de página na busca ou na execução: volta o PC para a
+        // instrução que falhou; a ISR de falha entra no próximo step
+        if (faulted())
+        {
+            abortInstruction();
+            return false;
+        }
+
+        // [METRICA] Contabiliza Instrução Executada (IPC)
+        if (stats)
+            stats->totalInstructions++;
+
+        // 3. DECODE (Decodificação)
+        DecodedInstruction decoded = decode();
+
+        // 4. EXECUTE (Execução)
+        execute(decoded);
+        if (faulted())
+        {
+            if (stats)
+                stats->totalInstructions--; // Não foi aposentada
+            abortInstruction();
+            return false;
+        }
+
+        // Sem modelo de tempo, a instrução multiciclo soma seus ciclos extras direto
+        if (!timingModel && stats)
+            stats->totalCycles += retired.execLatency - 1;
+
+        // 5. RETIRE: entrega a instrução ao modelo de tempo
+        if (timingModel)
+        {
+            unsigned long long waitAfterExec = stats ? stats->busWaitCycles : 0;
+            retired.pc = instructionPC;
+            retired.nextPC = registers.getPC();
+            retired.type = static_cast<InstructionType>(decoded.opcode);
+            retired.isAddressMode = decoded.isAddressMode;
+            retired.operand = decoded.operand;
+            retired.branchTaken = (retired.nextPC != instructionPC + 1) && !halted;
+            retired.fetchStall = (unsigned int)(waitAfterFetch - waitAfterIrq);
+            retired.dataStall = (unsigned int)((waitAfterIrq - waitBefore) + (waitAfterExec - waitAfterFetch));
+            timingModel->retire(retired);
+        }
+        return false;
+    }
+
     // --- Tratamento de Interrupções ---
     void checkInterrupts()
     {
         // Se interrupções desligadas, ou sem PIC, ou sem pedido, retorna.
-        if (!interruptsEnabled || pic == nullptr || !pic->isPending())
+        // Falha de página é não mascarável: a instrução não pode seguir sem ela.
+        if (pic == nullptr || !pic->isPending())
+            return;
+        if (!interruptsEnabled && !pic->isPending(IrqVector::PAGE_FAULT))
             return;
 
         // A CPU aceita a interrupção
@@ -99,33 +279,65 @@ private:
             unsigned long long latency = stats->totalCycles - stats->irqRequestTimestamp;
             stats->totalIrqLatency += latency;
             stats->irqCount++;
+            stats->irqLatencyHist.record(latency);
         }
+        isrFrames.push_back({stats ? stats->totalCycles : 0, 0});
 
         // 1. DESATIVA NOVAS INTERRUPÇÕES (Modo "Não Perturbe")
         interruptsEnabled = false;
+        retired.irqEntry = true;
+        retired.irqReturn = registers.getPC();
 
-        // Log Colorido para destaque
-        std::cout << Color::MAGENTA << Color::BOLD
-                  << "[CPU] INTERRUPT DETECTED! Vector: " << (int)vector
-                  << " (Interrupts Disabled)" << Color::RESET << std::endl;
+        // Evento de trace (renderizado em magenta fora do caminho quente)
+        if (tracer && tracer->enabled(TraceCategory::IRQ))
+        {
+            tracer->emit(TraceEvent::IRQ_ACCEPT, registers.getPC(), vector);
+        }
 
         // --- CONTEXT SWITCH (Usando a Pilha) ---
+        // A ISR roda em modo kernel (sem tradução); o modo anterior volta no RET
+        registers.enterKernel();
+
         // Salva o PC na pilha para permitir retorno depois
         push(registers.getPC());
 
         // Desvio baseado no vetor
-        if (vector == 1)
+        if (vector == IrqVector::KEYBOARD)
         {
             registers.setPC(500); // Endereço do Driver de Teclado
             // std::cout << "[CPU] Saltando para ISR (500)." << std::endl;
         }
+        else if (vector == IrqVector::PAGE_FAULT)
+        {
+            registers.setPC(700); // Tratador de falha de página
+        }
+    }
+
+    bool faulted() const { return mmu && mmu->hasFault(); }
+
+    // Descarta a instrução que falhou: nada foi escrito e o PC volta para ela
+    void abortInstruction()
+    {
+        registers.setPC(instructionPC);
+        mmu->clearFault();
+    }
+
+    // Registra o acesso a dados da instrução atual (para o retire trace)
+    void noteMemory(Address addr, bool isWrite)
+    {
+        retired.memAddr = addr;
+        retired.memRead = !isWrite;
+        retired.memWrite = isWrite;
     }
 
     // --- Estágios do Pipeline ---
     void fetch()
     {
         Address currentPC = registers.getPC();
-        Word instructionRaw = bus->read(currentPC);
+        instructionPC = currentPC;
+        if (tracer)
+            tracer->setPC(currentPC);
+        Word instructionRaw = fetchBus->read(currentPC);
         registers.setIR(instructionRaw);
         registers.incrementPC();
     }
@@ -161,6 +373,9 @@ private:
             if (instr.isAddressMode)
             {
                 operandValue = bus->read(instr.operand);
+                noteMemory(instr.operand, false);
+                if (faulted())
+                    return; // Sem writeback no ACC
             }
             else
             {
@@ -187,6 +402,9 @@ private:
         // Acesso à Memória
         case InstructionType::STORE:
             bus->write(instr.operand, registers.getACC());
+            noteMemory(instr.operand, true);
+            if (stats)
+                stats->cpuBytesCopied += sizeof(Word);
             break;
 
         // Controle de Fluxo
@@ -203,30 +421,156 @@ private:
 
         case InstructionType::PUSH:
             // Salva o ACC no topo da pilha
+            noteMemory(registers.getSP(), true);
             push(registers.getACC());
             break;
 
         case InstructionType::POP:
             // Recupera do topo da pilha para o ACC
-            registers.setACC(pop());
+            {
+                Word value = pop();
+                if (faulted())
+                    return;
+                registers.setACC(value);
+            }
+            noteMemory(registers.getSP(), false);
             break;
 
         case InstructionType::CALL:
             // 1. Salva PC atual
+            noteMemory(registers.getSP(), true);
             push(registers.getPC());
+            if (faulted())
+                return;
             // 2. Pula
             registers.setPC(instr.operand);
+            if (!isrFrames.empty())
+                isrFrames.back().callDepth++;
             break;
 
         case InstructionType::RET:
             // Recupera PC
-            registers.setPC(pop());
+            {
+                Word target = pop();
+                if (faulted())
+                    return;
+                registers.setPC(target);
+            }
+            noteMemory(registers.getSP(), false);
+            // Só o RET que fecha a ISR volta ao modo de antes dela; o RET de uma
+            // sub-rotina chamada pela ISR continua em kernel
+            if (!isrFrames.empty() && isrFrames.back().callDepth > 0)
+                isrFrames.back().callDepth--;
+            else if (!isrFrames.empty())
+            {
+                if (stats)
+                    stats->isrDurationHist.record(stats->totalCycles - isrFrames.back().entryCycle);
+                isrFrames.pop_back();
+                registers.returnFromIsr();
+            }
+            else
+                registers.returnFromCall(); // Fora de ISR (ou entra em usuário, se o kernel pediu)
             // Reativa interrupções ao retornar da função/ISR
             interruptsEnabled = true;
             break;
 
+        // --- OPERAÇÕES EM BLOCO ---
+        case InstructionType::SETSRC:
+            registers.setSRC(operandValue);
+            break;
+
+        case InstructionType::SETDST:
+            registers.setDST(operandValue);
+            break;
+
+        case InstructionType::MEMCPY:
+        case InstructionType::MEMSET:
+        case InstructionType::MEMCMP:
+            executeBlock(type, (Word)operandValue);
+            break;
+
+        // --- SIMD (4 lanes de 8 bits no ACC) ---
+        case InstructionType::PADDB:
+        case InstructionType::PXORB:
+        {
+            // Imediato só tem 23 bits: vale como um byte replicado nas lanes
+            uint32_t packed = instr.isAddressMode ? (uint32_t)operandValue : ALU::broadcastByte(instr.operand);
+            registers.setACC(alu.execute(instr.opcode, registers.getACC(), (int32_t)packed));
+            if (stats)
+                stats->simdInstructions++;
+        }
+        break;
+
         default:
             break;
         }
     }
+
+    // Executa MEMCPY/MEMSET/MEMCMP com memcpy do host (readBlock/writeBlock).
+    // Custo: 1 ciclo de decodificação + N/4 ciclos de datapath no EX, mais os
+    // ciclos de burst que a DRAM devolver (contados como espera de memória).
+    void executeBlock(InstructionType type, Word countValue)
+    {
+        size_t count = std::min((size_t)countValue, MAX_BLOCK_WORDS);
+        Address src = registers.getSRC();
+        Address dst = registers.getDST();
+        unsigned int memoryCycles = 0;
+
+        if (type == InstructionType::MEMCPY)
+        {
+            blockBuffer.assign(count, 0);
+            memoryCycles += bus->readBlock(src, blockBuffer.data(), count);
+            if (faulted())
+                return;
+            memoryCycles += bus->writeBlock(dst, blockBuffer.data(), count);
+            if (faulted())
+                return;
+            registers.setSRC(src + count);
+            registers.setDST(dst + count);
+            noteMemory(dst, true);
+            if (stats)
+                stats->blockBytesCopied += count * sizeof(Word);
+        }
+        else if (type == InstructionType::MEMSET)
+        {
+            blockBuffer.assign(count, (Word)registers.getACC());
+            memoryCycles += bus->writeBlock(dst, blockBuffer.data(), count);
+            if (faulted())
+                return;
+            registers.setDST(dst + count);
+            noteMemory(dst, true);
+            if (stats)
+                stats->blockBytesCopied += count * sizeof(Word);
+        }
+        else
+        {
+            blockBuffer.assign(count, 0);
+            compareBuffer.assign(count, 0);
+            memoryCycles += bus->readBlock(src, blockBuffer.data(), count);
+            memoryCycles += bus->readBlock(dst, compareBuffer.data(), count);
+            if (faulted())
+                return;
+
+            // Caminho rápido: memcmp do host; só procura o índice se diferir
+            int32_t result = 0;
+            if (count > 0 && std::memcmp(blockBuffer.data(), compareBuffer.data(), count * sizeof(Word)) != 0)
+            {
+                auto diff = std::mismatch(blockBuffer.begin(), blockBuffer.end(), compareBuffer.begin());
+                result = (int32_t)(diff.first - blockBuffer.begin()) + 1;
+            }
+            registers.setACC(result);
+            noteMemory(src, false);
+            if (stats)
+                stats->blockBytesCompared += count * 2 * sizeof(Word);
+        }
+
+        unsigned int execCycles = 1 + (unsigned int)((count + BLOCK_WORDS_PER_CYCLE - 1) / BLOCK_WORDS_PER_CYCLE);
+        retired.execLatency = execCycles;
+        if (stats)
+        {
+            stats->busWaitCycles += memoryCycles;
+            stats->blockInstructions++;
+            stats->blockCycles += execCycles + memoryCycles;
+        }
+    }
 };
\ No newline at end of file
@@ -1,14 +1,21 @@
 #pragma once
 #include "IMemoryDevice.h"
 #include <vector>
+#include <deque>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include "Colors.h"
 #include "Stats.h" // Necessário para contabilizar métricas
+#include "Trace.h" // Eventos binários (substitui os logs síncronos)
+#include "Prefetcher.h"
+#include "WriteBuffer.h"
+#include "VictimCache.h"
 
 struct CacheLine
 {
     bool valid = false;
+    bool prefetched = false; // Trazida por prefetch e ainda não usada pela demanda
     uint32_t tag = 0;
     std::vector<Word> dataBlock; // O Bloco de dados (ex: 4 palavras)
 };
@@ -22,12 +29,28 @@ private:
 
     size_t numLines;  // Quantas linhas a cache tem (ex: 8)
     size_t blockSize; // Quantas palavras cabem numa linha (ex: 4)
-    bool verbose;     // Controla se deve imprimir logs
+    Tracer *tracer;   // Trace binário (nullptr = sem logs)
+
+    // --- Prefetch (entre a Cache e a RAM) ---
+    Prefetcher *prefetcher = nullptr;
+    const Address *pcSource = nullptr; // PC da instrução corrente (para o stride)
+    Address memoryLimit = 0;           // Não busca além do fim da RAM
+    std::deque<uint32_t> prefetchQueue; // Blocos aguardando banda do barramento
+    size_t queueDepth = 8;
+    size_t issuePerAccess = 1;          // Banda: quantos prefetches por acesso de demanda
+    std::deque<uint32_t> evictedByPrefetch; // Vítimas recentes de prefetch (poluição)
+    std::vector<uint32_t> candidates;
+
+    // --- Buffer de Escrita (opcional) ---
+    WriteBuffer *writeBuffer = nullptr;
+
+    // --- Victim Cache (opcional) ---
+    VictimCache *victim = nullptr;
 
 public:
-    // Atualizado construtor para receber Stats* e agora o booleano verbose
-    Cache(IMemoryDevice *ram, Stats *s, size_t linesCount = 8, size_t wordsPerLine = 4, bool verboseMode = true)
-        : ramReal(ram), stats(s), numLines(linesCount), blockSize(wordsPerLine), verbose(verboseMode)
+    // Construtor recebe Stats* e o Tracer (antes era o booleano verbose)
+    Cache(IMemoryDevice *ram, Stats *s, size_t linesCount = 8, size_t wordsPerLine = 4, Tracer *t = nullptr)
+        : ramReal(ram), stats(s), numLines(linesCount), blockSize(wordsPerLine), tracer(t)
     {
         // Inicializa as linhas com vetores vazios do tamanho correto
         lines.resize(numLines);
@@ -37,6 +60,51 @@ public:
         }
     }
 
+    // Liga a Victim Cache: linhas expulsas vão para ela em vez de sumir
+    void setVictimCache(VictimCache *vc) { victim = vc; }
+
+    // Liga o buffer de escrita: STOREs deixam de ir síncronos para a RAM
+    void setWriteBuffer(WriteBuffer *wb) { writeBuffer = wb; }
+
+    // Esvazia o buffer de escrita (ordem dos dados antes de DMA/inspeção)
+    void flushWrites()
+    {
+        if (writeBuffer)
+            writeBuffer->drainAll();
+    }
+
+    // STORE ainda no buffer de escrita para 'addr' (inspeção do depurador)
+    bool pendingWrite(Address addr, Word &out) const
+    {
+        return writeBuffer && writeBuffer->pendingWord(addr, out);
+    }
+
+    // Escrita externa direto na RAM (depurador): atualiza as cópias, sem custo nem métrica
+    void patch(Address addr, Word value)
+    {
+        uint32_t blockAddr = addr / blockSize;
+        CacheLine &line = lines[blockAddr % numLines];
+        if (line.valid && line.tag == blockAddr / numLines)
+            line.dataBlock[addr % blockSize] = value;
+        if (victim)
+            victim->update(addr, value);
+    }
+
+    // Estado para checkpoints (sem prefetcher: a fila de prefetch fica vazia)
+    std::vector<CacheLine> saveLines() const { return lines; }
+    void restoreLines(const std::vector<CacheLine> &saved) { lines = saved; }
+
+    // Liga um prefetcher. 'limit' é o tamanho da RAM em palavras.
+    void setPrefetcher(Prefetcher *p, const Address *pc, Address limit,
+                       size_t depth = 8, size_t bandwidth = 1)
+    {
+        prefetcher = p;
+        pcSource = pc;
+        memoryLimit = limit;
+        queueDepth = depth;
+        issuePerAccess = bandwidth;
+    }
+
     Word read(Address addr) const override
     {
         // --- MATEMÁTICA DE ENDEREÇAMENTO ---
@@ -60,56 +128,133 @@ public:
         {
             // [METRICA] Hit
             if (stats)
+            {
                 stats->cacheHits++;
+                stats->memoryLatencyHist.record(1);
+            }
+
+            // Primeiro uso de um bloco trazido por prefetch
+            bool firstUse = line.prefetched;
+            if (firstUse)
+            {
+                line.prefetched = false;
+                if (stats)
+                    stats->prefetchUseful++;
+            }
+            // O prefetch pode reocupar esta mesma linha: lê antes de emitir
+            Word value = line.dataBlock[offset];
+            if (prefetcher)
+                const_cast<Cache *>(this)->prefetchStep(addr, blockAddr, firstUse);
 
             // [HIT] O bloco inteiro já está aqui!
-            if (verbose)
+            if (tracer && tracer->enabled(TraceCategory::CACHE))
             {
-                std::cout << Color::GREEN << "[CACHE HIT]  Addr: " << addr << Color::RESET << std::endl;
+                tracer->emit(TraceEvent::CACHE_HIT, addr);
             }
-            return line.dataBlock[offset];
+            return value;
         }
         else
         {
             // [METRICA] Miss
             if (stats)
-            {
                 stats->cacheMisses++;
-                stats->busWaitCycles += 10; // Penalidade simulada de latência da RAM
-            }
 
             // [MISS] Precisamos buscar o BLOCO INTEIRO na RAM
-            if (verbose)
+            if (tracer && tracer->enabled(TraceCategory::CACHE))
             {
-                std::cout << Color::RED << "[CACHE MISS] Addr: " << addr
-                          << " -> Buscando Bloco [" << (blockAddr * blockSize)
-                          << " a " << ((blockAddr * blockSize) + blockSize - 1) << "]..." << Color::RESET << std::endl;
+                tracer->emit(TraceEvent::CACHE_MISS, addr, blockAddr * blockSize, (uint16_t)blockSize);
             }
 
             // Endereço base do bloco na RAM
             Address baseAddress = blockAddr * blockSize;
 
-            // Busca sequencial (Simula o Burst Mode da RAM)
-            for (size_t i = 0; i < blockSize; i++)
+            Cache *self = const_cast<Cache *>(this);
+            if (prefetcher)
+                self->classifyMiss(blockAddr);
+
+            // Victim Cache: procura o bloco e, em seguida, guarda a linha que vai sair (swap)
+            std::vector<Word> victimData;
+            bool victimHit = false;
+            if (victim)
+            {
+                victimData.resize(blockSize);
+                victimHit = victim->take(blockAddr, victimData.data());
+                if (line.valid)
+                {
+                    victim->insert(line.tag * numLines + index, line.dataBlock.data());
+                    if (victimHit && stats)
+                        stats->victimSwaps++;
+                }
+            }
+
+            // Burst Mode: o bloco inteiro numa única transferência.
+            // O custo vem do próprio dispositivo (1ª palavra + custo por palavra).
+            // Se a Victim Cache ou o Stream Buffer já têm o bloco, custa 1 ciclo.
+            unsigned int burstCycles;
+            if (victimHit)
+            {
+                line.dataBlock = victimData;
+                burstCycles = 1;
+            }
+            else if (prefetcher && prefetcher->take(blockAddr, line.dataBlock.data(), blockSize))
+            {
+                burstCycles = 1;
+                if (stats)
+                {
+                    stats->prefetchUseful++;
+                    stats->prefetchBufferHits++;
+                }
+            }
+            else
+            {
+                burstCycles = ramReal->readBlock(baseAddress, line.dataBlock.data(), blockSize);
+            }
+
+            // Load forwarding: STOREs ainda no buffer valem mais que a RAM
+            if (writeBuffer)
+                writeBuffer->forward(blockAddr, line.dataBlock.data());
+            if (stats)
             {
-                line.dataBlock[i] = ramReal->read(baseAddress + i);
+                stats->busWaitCycles += burstCycles;
+                stats->missPenaltyCycles += burstCycles;
+                stats->memoryLatencyHist.record(1 + burstCycles);
             }
 
             // Atualiza Metadados
             line.valid = true;
+            line.prefetched = false;
             line.tag = tag;
 
-            return line.dataBlock[offset];
+            Word value = line.dataBlock[offset];
+            if (prefetcher)
+                self->prefetchStep(addr, blockAddr, true);
+
+            return value;
         }
     }
 
     void write(Address addr, Word value) override
     {
-        // Write-Through: Escreve na RAM sempre, e atualiza Cache se houver Hit
-
-        ramReal->write(addr, value);
+        // Write-Through: Escreve na RAM sempre, e atualiza Cache se houver Hit.
+        // Com buffer de escrita, o STORE entra na fila e só paga se ela estiver cheia.
+        if (writeBuffer)
+        {
+            unsigned long long now = stats ? stats->totalCycles : 0;
+            unsigned int stall = writeBuffer->push(addr, value, now);
+            if (stats)
+                stats->busWaitCycles += stall;
+        }
+        else
+        {
+            ramReal->write(addr, value);
+        }
 
         uint32_t blockAddr = addr / blockSize;
+        if (prefetcher)
+            prefetcher->invalidate(blockAddr); // Cópia no Stream Buffer ficou velha
+        if (victim)
+            victim->update(addr, value);
+
         uint32_t index = (blockAddr) % numLines;
         uint32_t tag = blockAddr / numLines;
         uint32_t offset = addr % blockSize;
@@ -118,17 +263,150 @@ public:
         {
             // Se o bloco está na cache, atualizamos a palavra específica nele
             lines[index].dataBlock[offset] = value;
-            if (verbose)
+            if (tracer && tracer->enabled(TraceCategory::CACHE))
             {
-                std::cout << "[CACHE UPDATE] Addr: " << addr << " (Write-Through)" << std::endl;
+                tracer->emit(TraceEvent::CACHE_UPDATE, addr);
             }
         }
         else
         {
-            if (verbose)
+            if (tracer && tracer->enabled(TraceCategory::CACHE))
             {
-                std::cout << "[CACHE BYPASS] Addr: " << addr << " (Write-Through)" << std::endl;
+                tracer->emit(TraceEvent::CACHE_BYPASS, addr);
             }
         }
     }
-};
\ No newline at end of file
+
+    // Leitura em bloco (MEMCPY/MEMCMP): com write-through a RAM já está em dia
+    // depois de drenar o buffer de escrita, então o burst vai direto e não polui as linhas
+    unsigned int readBlock(Address addr, Word *dst, size_t count) const override
+    {
+        const_cast<Cache *>(this)->flushWrites();
+        return ramReal->readBlock(addr, dst, count);
+    }
+
+    // Escrita em bloco (DMA / cópias): repassa à RAM num único burst e
+    // atualiza as linhas presentes na cache (mesma política Write-Through)
+    unsigned int writeBlock(Address addr, const Word *src, size_t count) override
+    {
+        flushWrites(); // STOREs anteriores não podem sobrescrever o bloco depois
+        unsigned int burstCycles = ramReal->writeBlock(addr, src, count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Address a = addr + i;
+            uint32_t blockAddr = a / blockSize;
+            if (prefetcher)
+                prefetcher->invalidate(blockAddr);
+            if (victim)
+                victim->update(a, src[i]);
+            CacheLine &line = lines[blockAddr % numLines];
+            if (line.valid && line.tag == blockAddr / numLines)
+            {
+                line.dataBlock[a % blockSize] = src[i];
+            }
+        }
+        return burstCycles;
+    }
+
+private:
+    // --- Prefetch ---
+
+    // Num miss de demanda: o bloco ainda estava na fila (prefetch atrasado)
+    // ou foi expulso por um prefetch (poluição)?
+    void classifyMiss(uint32_t blockAddr)
+    {
+        auto queued = std::find(prefetchQueue.begin(), prefetchQueue.end(), blockAddr);
+        if (queued != prefetchQueue.end())
+        {
+            prefetchQueue.erase(queued);
+            if (stats)
+                stats->prefetchLate++;
+        }
+
+        auto victim = std::find(evictedByPrefetch.begin(), evictedByPrefetch.end(), blockAddr);
+        if (victim != evictedByPrefetch.end())
+        {
+            evictedByPrefetch.erase(victim);
+            if (stats)
+                stats->prefetchPolluting++;
+        }
+    }
+
+    bool isResident(uint32_t blockAddr) const
+    {
+        const CacheLine &line = lines[blockAddr % numLines];
+        return line.valid && line.tag == blockAddr / numLines;
+    }
+
+    // Treina o prefetcher, enfileira candidatos e emite dentro da banda disponível
+    void prefetchStep(Address addr, uint32_t blockAddr, bool trigger)
+    {
+        Address pc = pcSource ? *pcSource : 0;
+        candidates.clear();
+        prefetcher->observe(addr, blockAddr, pc, trigger, candidates);
+
+        for (uint32_t candidate : candidates)
+        {
+            if ((Address)(candidate + 1) * blockSize > memoryLimit)
+                continue;
+            if (!prefetcher->ownsBuffer() && isResident(candidate))
+                continue;
+            if (std::find(prefetchQueue.begin(), prefetchQueue.end(), candidate) != prefetchQueue.end())
+                continue;
+            if (prefetchQueue.size() >= queueDepth)
+            {
+                if (stats)
+                    stats->prefetchDropped++;
+                continue;
+            }
+            prefetchQueue.push_back(candidate);
+        }
+
+        for (size_t i = 0; i < issuePerAccess && !prefetchQueue.empty(); i++)
+        {
+            uint32_t block = prefetchQueue.front();
+            prefetchQueue.pop_front();
+            issuePrefetch(block);
+        }
+    }
+
+    void issuePrefetch(uint32_t blockAddr)
+    {
+        std::vector<Word> data(blockSize);
+        unsigned int cycles = ramReal->readBlock(blockAddr * blockSize, data.data(), blockSize);
+        if (writeBuffer)
+            writeBuffer->forward(blockAddr, data.data());
+        if (stats)
+        {
+            stats->prefetchIssued++;
+            stats->prefetchBusCycles += cycles; // Banda consumida em segundo plano
+        }
+
+        if (prefetcher->ownsBuffer())
+        {
+            prefetcher->store(blockAddr, data.data(), blockSize);
+            return;
+        }
+
+        CacheLine &line = lines[blockAddr % numLines];
+        if (victim)
+        {
+            if (line.valid)
+                victim->insert(line.tag * numLines + (blockAddr % numLines), line.dataBlock.data());
+            victim->invalidate(blockAddr); // A linha passa a ter a cópia do bloco
+        }
+
+        // Expulsa um bloco de demanda: guardamos para detectar poluição
+        if (line.valid && !line.prefetched)
+        {
+            evictedByPrefetch.push_back(line.tag * numLines + (blockAddr % numLines));
+            if (evictedByPrefetch.size() > numLines * 2)
+                evictedByPrefetch.pop_front();
+        }
+        line.dataBlock = data;
+        line.valid = true;
+        line.prefetched = true;
+        line.tag = blockAddr / numLines;
+    }
+};
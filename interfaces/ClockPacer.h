@@ -0,0 +1,128 @@
+#pragma once
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+#include <time.h>
+
+// Ritmo do relógio do guest em tempo real.
+// Em vez de dormir a cada instrução, executa lotes de ~1 ms de ciclos e dorme
+// com clock_nanosleep até um prazo absoluto (início + ciclos / hz): o erro de
+// um lote não se acumula no seguinte e a frequência não deriva com a carga.
+// Se o host ficar para trás mais que MAX_LAG_NS (host lento, prompt do
+// --debug), o prazo é reancorado em vez de correr para recuperar o atraso.
+class ClockPacer
+{
+private:
+    static constexpr unsigned long long BATCH_NS = 1000000;   // Um lote por ~1 ms
+    static constexpr unsigned long long MAX_LAG_NS = 50000000; // 50 ms
+
+    double hz; // 0 = sem limite
+    unsigned long long batchCycles = 1;
+    unsigned long long nextCheck = 0;
+
+    // Âncora: o ciclo 'anchorCycle' deveria acontecer em 'anchorNs'
+    unsigned long long anchorCycle = 0;
+    unsigned long long anchorNs = 0;
+
+    unsigned long long startCycle = 0;
+    unsigned long long startNs = 0;
+    unsigned long long lagNs = 0; // Atraso na última checagem
+    unsigned long long maxLag = 0;
+    unsigned long long resyncs = 0;
+
+public:
+    explicit ClockPacer(double targetHz = 0) : hz(targetHz > 0 ? targetHz : 0)
+    {
+        if (hz > 0)
+        {
+            double perBatch = hz * BATCH_NS / 1e9;
+            batchCycles = perBatch < 1 ? 1 : (unsigned long long)perBatch;
+        }
+    }
+
+    // "1000", "2.5k", "4M", "1G"; "max" ou "0" = sem limite. false se inválido.
+    static bool parse(const std::string &text, double &out)
+    {
+        if (text == "max")
+        {
+            out = 0;
+            return true;
+        }
+        char *end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || value < 0)
+            return false;
+        std::string suffix(end);
+        if (suffix == "k" || suffix == "K")
+            value *= 1e3;
+        else if (suffix == "M")
+            value *= 1e6;
+        else if (suffix == "G")
+            value *= 1e9;
+        else if (!suffix.empty())
+            return false;
+        out = value;
+        return true;
+    }
+
+    static unsigned long long now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+
+    bool unthrottled() const { return hz == 0; }
+    double targetHz() const { return hz; }
+
+    // Chamado uma vez antes do primeiro passo
+    void start(unsigned long long cycle)
+    {
+        startCycle = anchorCycle = cycle;
+        startNs = anchorNs = now();
+        nextCheck = cycle + batchCycles;
+    }
+
+    // Chamado a cada passo: fora da fronteira do lote é só uma comparação
+    void pace(unsigned long long cycle)
+    {
+        if (hz == 0 || cycle < nextCheck)
+            return;
+        nextCheck = cycle + batchCycles;
+
+        unsigned long long deadline = anchorNs + (unsigned long long)((cycle - anchorCycle) * 1e9 / hz);
+        unsigned long long current = now();
+        if (current >= deadline)
+        {
+            lagNs = current - deadline;
+            if (lagNs > maxLag)
+                maxLag = lagNs;
+            if (lagNs > MAX_LAG_NS)
+            {
+                anchorCycle = cycle;
+                anchorNs = current;
+                resyncs++;
+            }
+            return;
+        }
+        lagNs = 0;
+
+        struct timespec ts;
+        ts.tv_sec = (time_t)(deadline / 1000000000ULL);
+        ts.tv_nsec = (long)(deadline % 1000000000ULL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        {
+        }
+    }
+
+    // Frequência real desde o start()
+    double actualHz(unsigned long long cycle) const
+    {
+        unsigned long long elapsed = now() - startNs;
+        return elapsed ? (cycle - startCycle) * 1e9 / elapsed : 0.0;
+    }
+
+    unsigned long long currentLagNs() const { return lagNs; }
+    unsigned long long maxLagNs() const { return maxLag; }
+    unsigned long long resyncCount() const { return resyncs; }
+};
@@ -0,0 +1,378 @@
+#pragma once
+#include "Machine.h"
+#include "TimeTravel.h"
+#include "Colors.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Monitor interativo do 'run --debug': breakpoints, watchpoints e inspeção.
+// Só custa algo enquanto houver breakpoint/watchpoint armado; o prompt lê a
+// entrada padrão byte a byte para não roubar teclas do teclado do guest.
+class DebugMonitor
+{
+private:
+    struct WatchEntry
+    {
+        int id;        // Id do monitor (compartilhado com os breakpoints)
+        int machineId; // Id dentro da Machine
+        Address low, high;
+        uint8_t kinds;
+    };
+
+    struct WatchHit
+    {
+        int id;
+        MemoryAccess access;
+    };
+
+    Machine &machine;
+    TimeTravel *travel = nullptr; // Opcional: rs, rc, goto
+    bool terminal; // Teclado em modo raw: volta ao modo normal durante o prompt
+    bool quitRequested = false;
+    bool detached = false; // EOF na entrada: segue sem prompt
+    unsigned long long stepsLeft = 0;
+
+    std::vector<WatchEntry> watches;
+    std::vector<WatchHit> hits;
+    int nextWatchId = 1000; // Separados dos ids de breakpoint no 'list' e no 'd'
+
+public:
+    DebugMonitor(Machine &target, bool usesTerminal) : machine(target), terminal(usesTerminal) {}
+
+    bool quit() const { return quitRequested; }
+
+    void setTimeTravel(TimeTravel *timeTravel) { travel = timeTravel; }
+
+    // Chamado pelo laço do 'run' depois de cada machine.step()
+    void afterStep(bool breakHit)
+    {
+        if (detached)
+            return;
+        if (breakHit)
+        {
+            const auto *bp = machine.breakpoints().find(machine.breakpoints().lastHit());
+            std::ostringstream reason;
+            reason << "breakpoint #" << machine.breakpoints().lastHit() << " em PC " << machine.registers().getPC();
+            if (bp && bp->condition.reg != BreakCondition::ALWAYS)
+                reason << " (" << bp->condition.text() << ")";
+            prompt(reason.str());
+        }
+        else if (!hits.empty())
+        {
+            std::ostringstream reason;
+            const WatchHit &hit = hits.front();
+            reason << "watchpoint #" << hit.id << ": " << (hit.access.isWrite ? "escrita" : "leitura") << " em "
+                   << hit.access.addr << " = " << (int32_t)hit.access.value << " (PC " << hit.access.pc << ")";
+            if (hits.size() > 1)
+                reason << " +" << hits.size() - 1;
+            hits.clear();
+            prompt(reason.str());
+        }
+        else if (stepsLeft > 0 && --stepsLeft == 0)
+            prompt("passo");
+    }
+
+    // Lê comandos até 'c', 's' ou 'q'
+    void prompt(const std::string &reason)
+    {
+        if (detached)
+            return;
+        std::cout << Color::MAGENTA << "[DEBUG] " << reason << " | ciclo " << machine.cycle() << Color::RESET << std::endl;
+        if (terminal)
+            machine.getKeyboard().disableRawMode();
+
+        while (true)
+        {
+            std::cout << "(dbg) " << std::flush;
+            std::string line;
+            if (!readLine(line))
+            {
+                std::cout << "\n[DEBUG] Fim da entrada: continuando sem o monitor." << std::endl;
+                detached = true;
+                break;
+            }
+            if (execute(line))
+                break;
+        }
+
+        if (terminal)
+            machine.getKeyboard().enableRawMode();
+    }
+
+private:
+    static bool readLine(std::string &line)
+    {
+        char c;
+        while (::read(STDIN_FILENO, &c, 1) == 1)
+        {
+            if (c == '\n')
+                return true;
+            line += c;
+        }
+        return !line.empty();
+    }
+
+    static bool parseNumber(const std::string &text, long &value)
+    {
+        if (text.empty())
+            return false;
+        char *end = nullptr;
+        value = std::strtol(text.c_str(), &end, 0);
+        return *end == '\0';
+    }
+
+    // Retorna true quando a simulação deve seguir
+    bool execute(const std::string &line)
+    {
+        std::istringstream in(line);
+        std::string cmd;
+        if (!(in >> cmd))
+            return false;
+
+        if (cmd == "c" || cmd == "continue")
+            return true;
+        if (cmd == "s" || cmd == "step")
+        {
+            long n = 1;
+            std::string arg;
+            if (in >> arg && (!parseNumber(arg, n) || n < 1))
+            {
+                std::cout << "uso: s [N]" << std::endl;
+                return false;
+            }
+            stepsLeft = (unsigned long long)n;
+            return true;
+        }
+        if (cmd == "q" || cmd == "quit")
+        {
+            quitRequested = true;
+            return true;
+        }
+        if (cmd == "b" || cmd == "break")
+            addBreakpoint(in);
+        else if (cmd == "w" || cmd == "watch")
+            addWatchpoint(in);
+        else if (cmd == "d" || cmd == "delete")
+            remove(in);
+        else if (cmd == "l" || cmd == "list")
+            list();
+        else if (cmd == "r" || cmd == "regs")
+        {
+            machine.registers().dump();
+            std::cout << std::setfill(' ') << std::dec << "Ciclo: " << machine.cycle() << "  Instrucoes: "
+                      << machine.stats().totalInstructions << std::endl;
+        }
+        else if (cmd == "x")
+            examine(in);
+        else if (cmd == "stats")
+            machine.stats().printReport();
+        else if (cmd == "rs" || cmd == "rc" || cmd == "goto" || cmd == "tt")
+            timeTravel(cmd, in);
+        else
+            help();
+        return false;
+    }
+
+    // b <pc|*> [if acc|sp <op> <valor>]
+    void addBreakpoint(std::istringstream &in)
+    {
+        std::string where, keyword;
+        long pc = 0;
+        if (!(in >> where) || (where != "*" && (!parseNumber(where, pc) || pc < 0)))
+        {
+            std::cout << "uso: b <pc|*> [if acc|sp <op> <valor>]" << std::endl;
+            return;
+        }
+        BreakCondition condition;
+        if (in >> keyword)
+        {
+            std::string rest;
+            std::getline(in, rest);
+            if (keyword != "if" || !BreakCondition::parse(rest, condition))
+            {
+                std::cout << "condicao invalida (ex.: if acc == 3, if sp < 900)" << std::endl;
+                return;
+            }
+        }
+        else if (where == "*")
+        {
+            std::cout << "b * precisa de condicao" << std::endl;
+            return;
+        }
+        Address at = where == "*" ? BreakpointSet::ANY_PC : (Address)pc;
+        std::cout << "breakpoint #" << machine.breakpoints().add(at, condition) << std::endl;
+    }
+
+    // w <inicio>[:<fim>] [r|w|rw]
+    void addWatchpoint(std::istringstream &in)
+    {
+        std::string range, mode = "w";
+        long low = 0, high = 0;
+        if (!(in >> range))
+        {
+            std::cout << "uso: w <inicio>[:<fim>] [r|w|rw]" << std::endl;
+            return;
+        }
+        in >> mode;
+        size_t colon = range.find(':');
+        bool ok = parseNumber(range.substr(0, colon), low);
+        high = low;
+        if (ok && colon != std::string::npos)
+            ok = parseNumber(range.substr(colon + 1), high);
+        uint8_t kinds = (mode.find('r') != std::string::npos ? WatchKind::READ : 0) |
+                        (mode.find('w') != std::string::npos ? WatchKind::WRITE : 0);
+        if (!ok || low < 0 || high < low || kinds == 0)
+        {
+            std::cout << "uso: w <inicio>[:<fim>] [r|w|rw]" << std::endl;
+            return;
+        }
+
+        int id = nextWatchId++;
+        int machineId = machine.addWatch((Address)low, (Address)high, kinds, [this, id](const MemoryAccess &access)
+                                         {
+                                             hits.push_back({id, access});
+                                             machine.stop();
+                                         });
+        watches.push_back({id, machineId, (Address)low, (Address)high, kinds});
+        std::cout << "watchpoint #" << id << std::endl;
+    }
+
+    void remove(std::istringstream &in)
+    {
+        long id = 0;
+        std::string arg;
+        if (!(in >> arg) || !parseNumber(arg, id))
+        {
+            std::cout << "uso: d <id>" << std::endl;
+            return;
+        }
+        for (size_t i = 0; i < watches.size(); i++)
+        {
+            if (watches[i].id == id)
+            {
+                machine.removeWatch(watches[i].machineId);
+                watches.erase(watches.begin() + i);
+                return;
+            }
+        }
+        if (!machine.breakpoints().remove((int)id))
+            std::cout << "nao existe: " << id << std::endl;
+    }
+
+    void list()
+    {
+        for (const auto &bp : machine.breakpoints().all())
+        {
+            std::cout << "#" << bp.id << "  break ";
+            if (bp.pc == BreakpointSet::ANY_PC)
+                std::cout << "*";
+            else
+                std::cout << bp.pc;
+            if (bp.condition.reg != BreakCondition::ALWAYS)
+                std::cout << " if " << bp.condition.text();
+            std::cout << "  (" << bp.hits << " paradas)" << std::endl;
+        }
+        for (const WatchEntry &w : watches)
+        {
+            std::cout << "#" << w.id << "  watch " << w.low;
+            if (w.high != w.low)
+                std::cout << ":" << w.high;
+            std::cout << " " << ((w.kinds & WatchKind::READ) ? "r" : "") << ((w.kinds & WatchKind::WRITE) ? "w" : "") << std::endl;
+        }
+        if (machine.breakpoints().empty() && watches.empty())
+            std::cout << "nenhum breakpoint ou watchpoint" << std::endl;
+    }
+
+    // x <endereco> [N]: N palavras da RAM (sem passar pela Cache)
+    void examine(std::istringstream &in)
+    {
+        long addr = 0, count = 8;
+        std::string a, n;
+        if (!(in >> a) || !parseNumber(a, addr) || addr < 0 || (in >> n && !parseNumber(n, count)))
+        {
+            std::cout << "uso: x <endereco> [N]" << std::endl;
+            return;
+        }
+        for (long i = 0; i < count && (size_t)(addr + i) < machine.ramSize(); i++)
+        {
+            Word value = machine.peek((Address)(addr + i));
+            std::cout << std::setfill(' ') << std::dec << std::setw(5) << addr + i << ": 0x" << std::hex << std::uppercase
+                      << std::setw(8) << std::setfill('0') << value << std::setfill(' ') << std::dec << "  " << (int32_t)value
+                      << std::endl;
+        }
+    }
+
+    // Comandos da viagem no tempo: a máquina fica parada no destino
+    void timeTravel(const std::string &cmd, std::istringstream &in)
+    {
+        if (!travel)
+        {
+            std::cout << "viagem no tempo desligada (use --time-travel <passos>)" << std::endl;
+            return;
+        }
+        if (cmd == "tt")
+        {
+            std::cout << travel->checkpointCount() << " checkpoints (" << travel->memoryBytes() / 1024 << " KB, "
+                      << travel->droppedCheckpoints() << " descartados), historico desde o ciclo " << travel->oldestCycle()
+                      << ", passo atual " << travel->currentStep() << " de " << travel->frontierStep() << std::endl;
+            return;
+        }
+
+        bool ok;
+        std::string arg;
+        long n = 1;
+        if (cmd == "rs")
+        {
+            if (in >> arg && (!parseNumber(arg, n) || n < 1))
+            {
+                std::cout << "uso: rs [N]" << std::endl;
+                return;
+            }
+            ok = travel->reverseStep((unsigned long long)n);
+        }
+        else if (cmd == "rc")
+            ok = travel->reverseContinue();
+        else
+        {
+            if (!(in >> arg) || !parseNumber(arg, n) || n < 0)
+            {
+                std::cout << "uso: goto <ciclo>" << std::endl;
+                return;
+            }
+            ok = travel->gotoCycle((unsigned long long)n);
+        }
+
+        // Paradas vistas no caminho não contam: a posição é o destino
+        hits.clear();
+        machine.consumeStop();
+        if (!ok)
+            std::cout << "fora do historico (mais antigo: ciclo " << travel->oldestCycle() << ")" << std::endl;
+        std::cout << Color::MAGENTA << "[DEBUG] PC " << machine.registers().getPC() << " | ciclo " << machine.cycle()
+                  << (machine.isHalted() ? " | HALT" : "") << Color::RESET << std::endl;
+    }
+
+    void help()
+    {
+        std::cout << "c                      continua\n"
+                     "s [N]                  executa N passos\n"
+                     "b <pc> [if <cond>]     breakpoint (cond: acc|sp ==|!=|<|<=|>|>= valor)\n"
+                     "b * if <cond>          condicao checada em todo passo\n"
+                     "w <ini>[:<fim>] [r|w|rw] watchpoint (padrao: escrita)\n"
+                     "d <id>                 remove breakpoint/watchpoint\n"
+                     "l                      lista\n"
+                     "r                      registradores\n"
+                     "x <end> [N]            memoria\n"
+                     "stats                  relatorio do Stats\n"
+                     "rs [N]                 volta N instrucoes (--time-travel)\n"
+                     "rc                     volta ate o breakpoint/watchpoint anterior\n"
+                     "goto <ciclo>           vai ao ciclo (para tras ou para frente)\n"
+                     "tt                     estado dos checkpoints\n"
+                     "q                      encerra a simulacao"
+                  << std::endl;
+    }
+};
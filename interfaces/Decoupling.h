@@ -0,0 +1,275 @@
+#pragma once
+#include "Machine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Fila circular lock-free de um produtor e um consumidor (como o TraceRing,
+// mas genérica). Capacidade potência de 2: o índice é só uma máscara.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacidade deve ser potencia de 2");
+
+private:
+    std::unique_ptr<T[]> items;
+    std::atomic<size_t> head{0}; // Próxima escrita (produtor)
+    std::atomic<size_t> tail{0}; // Próxima leitura (consumidor)
+
+public:
+    SpscQueue() : items(new T[Capacity]) {}
+
+    // Nunca bloqueia: false se a fila estiver cheia
+    bool push(const T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity)
+            return false;
+        items[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &out)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        out = items[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// Barreira reutilizável de N participantes (o C++17 não tem std::barrier).
+// Gira um pouco antes de dormir: com quanta curtos a espera é de microssegundos.
+// Quem espera roda 'idle' no meio tempo (ex.: drenar a fila de quem ainda produz).
+class QuantumBarrier
+{
+private:
+    static constexpr int SPIN_LIMIT = 2000;
+
+    const unsigned parties;
+    std::atomic<unsigned> waiting{0};
+    std::atomic<unsigned long long> generation{0};
+    std::mutex mutex;
+    std::condition_variable released;
+
+public:
+    explicit QuantumBarrier(unsigned count) : parties(count) {}
+
+    template <typename Idle>
+    void arriveAndWait(Idle &&idle)
+    {
+        unsigned long long gen = generation.load(std::memory_order_acquire);
+        if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == parties)
+        {
+            // Último a chegar: zera antes de liberar (ninguém sai antes da troca de geração)
+            waiting.store(0, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                generation.store(gen + 1, std::memory_order_release);
+            }
+            released.notify_all();
+            return;
+        }
+
+        for (int spin = 0; spin < SPIN_LIMIT; spin++)
+        {
+            if (generation.load(std::memory_order_acquire) != gen)
+                return;
+            idle();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (generation.load(std::memory_order_acquire) == gen)
+        {
+            released.wait_for(lock, std::chrono::milliseconds(1));
+            lock.unlock();
+            idle();
+            lock.lock();
+        }
+    }
+};
+
+// Escrita MMIO da CPU com o relógio local de quem escreveu
+struct MmioEvent
+{
+    unsigned long long cycle;
+    Address addr;
+    Word value;
+};
+
+// Pedido de interrupção de um dispositivo, com o dado que a ISR vai ler
+struct IrqEvent
+{
+    unsigned long long cycle; // Início do quantum em que o dispositivo viu o evento
+    uint8_t vector;
+    char data;
+};
+
+// Lado da CPU do display: cada escrita MMIO vira um evento na fila do thread do
+// display. O display não tem registrador legível, então a leitura não sai daqui.
+class DisplayPort : public IMemoryDevice
+{
+private:
+    SpscQueue<MmioEvent, 4096> &queue;
+    const unsigned long long *cycle;
+
+public:
+    DisplayPort(SpscQueue<MmioEvent, 4096> &target, const unsigned long long *cyclePtr) : queue(target), cycle(cyclePtr) {}
+
+    Word read(Address) const override { return 0; }
+
+    void write(Address addr, Word value) override
+    {
+        // Fila cheia: o thread do display drena até na barreira, então é só esperar
+        while (!queue.push({*cycle, addr, value}))
+            std::this_thread::yield();
+    }
+};
+
+// Desacoplamento temporal (estilo TLM): CPU, teclado e display em threads
+// separados. A CPU roda 'quantum' ciclos sem olhar para os dispositivos; na
+// fronteira os três se encontram numa barreira e as teclas vistas pelo thread
+// do teclado entram na fila da máquina (a IRQ sai no tick seguinte). Quanto
+// maior o quantum, menos sincronização e maior o atraso entre a tecla e a IRQ.
+class QuantumScheduler
+{
+private:
+    Machine &machine;
+    unsigned long long quantum;
+    unsigned long long nextBoundary;
+
+    SpscQueue<MmioEvent, 4096> displayQueue; // CPU -> display
+    SpscQueue<IrqEvent, 256> irqQueue;       // Teclado -> CPU
+    DisplayPort port;
+
+    QuantumBarrier barrier{3};
+    // Número da fronteira em que os dispositivos saem. Um flag simples não basta:
+    // quem acorda atrasado da fronteira anterior já o veria e faltaria na última.
+    std::atomic<unsigned long long> stopBoundary{~0ULL};
+    std::atomic<unsigned long long> quantumStart{0}; // Relógio da CPU na última fronteira
+    std::thread keyboardThread;
+    std::thread displayThread;
+    bool running = false;
+
+    IrqEvent held{}; // Só o thread do teclado mexe
+    bool heldKey = false;
+
+    unsigned long long quanta = 0;
+    unsigned long long keysDelivered = 0;
+    unsigned long long totalKeyDelay = 0; // Ciclos entre o quantum em que a tecla chegou e a entrega
+
+public:
+    QuantumScheduler(Machine &target, unsigned long long quantumCycles)
+        : machine(target), quantum(quantumCycles ? quantumCycles : 1),
+          port(displayQueue, &machine.stats().totalCycles)
+    {
+        nextBoundary = machine.cycle() + quantum;
+        quantumStart = machine.cycle();
+        machine.getKeyboard().setExternalInput(true);
+        machine.getBus().setDisplay(&port);
+
+        running = true;
+        keyboardThread = std::thread([this]()
+                                     { deviceLoop([this]()
+                                                  { pollKeyboard(); }); });
+        displayThread = std::thread([this]()
+                                    { deviceLoop([this]()
+                                                 { drainDisplay(); }); });
+    }
+
+    ~QuantumScheduler() { stop(); }
+
+    QuantumScheduler(const QuantumScheduler &) = delete;
+    QuantumScheduler &operator=(const QuantumScheduler &) = delete;
+
+    // Chamado pelo laço do 'run' depois de cada passo: quase sempre só uma comparação
+    void tick()
+    {
+        if (machine.cycle() >= nextBoundary)
+            boundary();
+    }
+
+    // Última fronteira: libera os dispositivos, espera o display escrever tudo
+    // e devolve o barramento e o terminal à máquina
+    void stop()
+    {
+        if (!running)
+            return;
+        running = false;
+        stopBoundary.store(quanta + 1, std::memory_order_release);
+        barrier.arriveAndWait([]() {});
+        keyboardThread.join();
+        displayThread.join();
+        machine.getBus().setDisplay(&machine.getDisplay());
+        machine.getKeyboard().setExternalInput(false);
+    }
+
+    unsigned long long quantumCycles() const { return quantum; }
+    unsigned long long quantaRun() const { return quanta; }
+    unsigned long long keys() const { return keysDelivered; }
+    double averageKeyDelay() const { return keysDelivered ? (double)totalKeyDelay / keysDelivered : 0.0; }
+
+private:
+    void boundary()
+    {
+        barrier.arriveAndWait([]() {});
+        unsigned long long now = machine.cycle();
+        IrqEvent event;
+        while (irqQueue.pop(event))
+        {
+            machine.feedKeys(std::string(1, event.data));
+            totalKeyDelay += now - event.cycle;
+            keysDelivered++;
+        }
+        quanta++;
+        quantumStart.store(now, std::memory_order_relaxed);
+        nextBoundary = now + quantum;
+    }
+
+    // Cada dispositivo trabalha no seu ritmo dentro do quantum e espera na fronteira
+    template <typename Service>
+    void deviceLoop(Service service)
+    {
+        for (unsigned long long passed = 1;; passed++)
+        {
+            service();
+            barrier.arriveAndWait(service);
+            if (passed == stopBoundary.load(std::memory_order_acquire))
+                break;
+        }
+        service(); // O que a CPU produziu até o fim
+    }
+
+    void pollKeyboard()
+    {
+        // Fila cheia: a tecla fica guardada até a CPU esvaziar a fila na fronteira
+        // (esperar aqui travaria a barreira)
+        if (heldKey && !irqQueue.push(held))
+            return;
+        heldKey = false;
+        char c;
+        while (Keyboard::readTerminal(c))
+        {
+            IrqEvent event{quantumStart.load(std::memory_order_relaxed), IrqVector::KEYBOARD, c};
+            if (!irqQueue.push(event))
+            {
+                held = event;
+                heldKey = true;
+                return;
+            }
+        }
+    }
+
+    void drainDisplay()
+    {
+        MmioEvent event;
+        while (displayQueue.pop(event))
+            machine.getDisplay().write(event.addr, event.value);
+    }
+};
@@ -1,7 +1,10 @@
 #pragma once
 #include "IMemoryDevice.h"
 #include "Colors.h"
+#include "DisplaySink.h"
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
 
 class Display : public IMemoryDevice
@@ -9,7 +12,35 @@ class Display : public IMemoryDevice
 private:
     std::string internalBuffer; // A memória interna do Display
 
+    // Destino das linhas (console, assíncrono ou headless)
+    DisplaySink *sink;
+    std::unique_ptr<DisplaySink> ownedSink; // Usado quando ninguém injeta um sink
+
+    // Opcional: recebe cada linha crua no FLUSH (quem embute a máquina)
+    std::function<void(const std::string &)> lineListener;
+
+    bool muted = false; // Replay da viagem no tempo: as linhas já foram mostradas
+
 public:
+    // Sem sink injetado, mantém o comportamento original (console síncrono)
+    Display(DisplaySink *outputSink = nullptr) : sink(outputSink)
+    {
+        if (sink == nullptr)
+        {
+            ownedSink.reset(new ConsoleSink());
+            sink = ownedSink.get();
+        }
+    }
+
+    DisplaySink *getSink() const { return sink; }
+
+    void setLineListener(std::function<void(const std::string &)> listener) { lineListener = std::move(listener); }
+    void setMuted(bool value) { muted = value; }
+
+    // Texto acumulado antes do FLUSH (estado do checkpoint)
+    const std::string &pendingText() const { return internalBuffer; }
+    void setPendingText(const std::string &text) { internalBuffer = text; }
+
     Word read(Address addr) const override
     {
         // Em hardware real, ler o COMMAND register poderia retornar
@@ -35,8 +66,12 @@ public:
             case 1: // FLUSH (Imprimir)
                 if (!internalBuffer.empty())
                 {
-                    std::cout << Color::CYAN << "[DISPLAY] " << internalBuffer << Color::RESET << std::endl
-                              << std::flush;
+                    if (!muted)
+                    {
+                        if (lineListener)
+                            lineListener(internalBuffer);
+                        sink->emit(Color::CYAN + "[DISPLAY] " + internalBuffer + Color::RESET + "\n");
+                    }
                     internalBuffer.clear(); // Limpa após mostrar
                 }
                 break;
@@ -46,7 +81,8 @@ public:
                 break;
 
             case 3: // NEWLINE (Facilitador: Pula linha)
-                std::cout << std::endl;
+                if (!muted)
+                    sink->emit("\n");
                 break;
             }
         }
@@ -0,0 +1,177 @@
+#pragma once
+#include "Colors.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+// Destino físico das linhas do Display.
+// O Display só monta o texto; quem decide QUANDO e COMO escrever é o sink.
+class DisplaySink
+{
+public:
+    virtual ~DisplaySink() = default;
+
+    // Recebe um pedaço de texto já formatado (com cores e '\n')
+    virtual void emit(const std::string &text) = 0;
+
+    // Força a saída de tudo que estiver pendente (ex: no Shutdown)
+    virtual void close() {}
+
+    virtual unsigned long long bytesWritten() const = 0;
+};
+
+// --- Sink Síncrono (comportamento original: escreve e dá flush na hora) ---
+class ConsoleSink : public DisplaySink
+{
+private:
+    unsigned long long bytes = 0;
+
+public:
+    void emit(const std::string &text) override
+    {
+        std::cout << text << std::flush;
+        bytes += text.size();
+    }
+
+    unsigned long long bytesWritten() const override { return bytes; }
+};
+
+// --- Sink Headless (benchmarks): apenas conta bytes, não faz I/O ---
+class NullSink : public DisplaySink
+{
+private:
+    unsigned long long bytes = 0;
+
+public:
+    void emit(const std::string &text) override { bytes += text.size(); }
+
+    unsigned long long bytesWritten() const override { return bytes; }
+};
+
+// Política de descarga do buffer assíncrono
+enum class FlushPolicy
+{
+    EVERY_LINE, // Acorda o escritor a cada linha (interativo)
+    BATCH,      // Acorda ao passar do limite de bytes ou do intervalo
+    AT_EXIT     // Só escreve no close()
+};
+
+// --- Sink Assíncrono ---
+// A thread da simulação só faz append num buffer grande (sem syscall).
+// Uma thread escritora troca o buffer e faz um único write() por lote.
+class AsyncSink : public DisplaySink
+{
+private:
+    FlushPolicy policy;
+    size_t batchBytes;                      // Limite para acordar o escritor (BATCH)
+    std::chrono::milliseconds batchTimeout; // Intervalo máximo sem escrever (BATCH)
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::string pending; // Buffer preenchido pela simulação
+    bool stopping = false;
+
+    std::thread writer;
+    std::atomic<unsigned long long> bytes{0};
+
+public:
+    AsyncSink(FlushPolicy flushPolicy = FlushPolicy::EVERY_LINE, size_t thresholdBytes = 64 * 1024,
+              unsigned int timeoutMs = 50)
+        : policy(flushPolicy), batchBytes(thresholdBytes), batchTimeout(timeoutMs)
+    {
+        pending.reserve(thresholdBytes * 2);
+        writer = std::thread([this]()
+                             { writerLoop(); });
+    }
+
+    ~AsyncSink()
+    {
+        close();
+    }
+
+    void emit(const std::string &text) override
+    {
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending += text;
+            notify = (policy == FlushPolicy::EVERY_LINE) ||
+                     (policy == FlushPolicy::BATCH && pending.size() >= batchBytes);
+        }
+        if (notify)
+            wakeUp.notify_one();
+    }
+
+    void close() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping)
+                return;
+            stopping = true;
+        }
+        wakeUp.notify_one();
+        writer.join();
+    }
+
+    unsigned long long bytesWritten() const override { return bytes.load(); }
+
+private:
+    void writerLoop()
+    {
+        std::string local;
+        local.reserve(pending.capacity());
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            if (policy == FlushPolicy::BATCH)
+            {
+                wakeUp.wait_for(lock, batchTimeout, [this]()
+                                { return stopping || pending.size() >= batchBytes; });
+            }
+            else
+            {
+                wakeUp.wait(lock, [this]()
+                            { return stopping || (policy == FlushPolicy::EVERY_LINE && !pending.empty()); });
+            }
+
+            // Troca os buffers: a simulação continua escrevendo no vazio
+            local.swap(pending);
+            bool done = stopping;
+            lock.unlock();
+
+            if (!local.empty())
+            {
+                std::cout << std::flush; // Mantém a ordem com o que já foi para o cout
+                writeAll(local);
+                bytes += local.size();
+                local.clear();
+            }
+
+            if (done)
+                return;
+            lock.lock();
+        }
+    }
+
+    // Um único write() por lote (repete só se o kernel aceitar parcial)
+    static void writeAll(const std::string &data)
+    {
+        const char *ptr = data.data();
+        size_t left = data.size();
+        while (left > 0)
+        {
+            ssize_t n = ::write(STDOUT_FILENO, ptr, left);
+            if (n <= 0)
+                return;
+            ptr += n;
+            left -= (size_t)n;
+        }
+    }
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include "Types.h"
+#include "Stats.h"
+#include <cstddef>
+#include <vector>
+
+// Parâmetros de tempo da DRAM (em ciclos da CPU)
+struct DramConfig
+{
+    size_t numBanks = 4;      // Bancos independentes, cada um com seu row buffer
+    size_t rowSizeWords = 64; // Palavras por linha (página) da DRAM
+    unsigned int tCAS = 4;    // Coluna: linha já aberta -> dado
+    unsigned int tRCD = 4;    // Ativação: abre a linha no row buffer
+    unsigned int tRP = 4;     // Precharge: fecha a linha aberta anterior
+    unsigned int perWordCycles = 1; // Cada palavra extra do burst
+    unsigned int tWTR = 2;    // Turnaround: leitura logo depois de uma escrita
+};
+
+// Classificação de um acesso em relação ao row buffer do banco
+enum class RowResult
+{
+    HIT,      // Linha já aberta: só tCAS
+    MISS,     // Banco fechado: tRCD + tCAS
+    CONFLICT  // Outra linha aberta: tRP + tRCD + tCAS
+};
+
+// Modelo de DRAM com bancos e política de página aberta.
+// Os bursts chegam um por vez (a Cache espera cada um; prefetch e drenagem do
+// buffer de escrita também são resolvidos no instante em que saem), então não
+// há fila para reordenar: cada acesso é atendido na hora, na ordem de chegada.
+class DramController
+{
+private:
+    DramConfig config;
+    Stats *stats;
+
+    struct Bank
+    {
+        bool open = false;
+        Address row = 0;
+    };
+    std::vector<Bank> banks;
+    bool lastWasWrite = false; // Sentido do barramento de dados no último burst
+
+public:
+    DramController(DramConfig cfg = DramConfig(), Stats *s = nullptr)
+        : config(cfg), stats(s)
+    {
+        banks.resize(config.numBanks);
+    }
+
+    const DramConfig &getConfig() const { return config; }
+
+    // --- Mapeamento de Endereço ---
+    // Linhas consecutivas são intercaladas entre os bancos
+    size_t bankOf(Address addr) const { return (addr / config.rowSizeWords) % config.numBanks; }
+    Address rowOf(Address addr) const { return addr / (config.rowSizeWords * config.numBanks); }
+
+    // Atende um burst de 'words' palavras e retorna a latência em ciclos
+    unsigned int access(Address addr, size_t words, bool isWrite)
+    {
+        RowResult result = classify(addr);
+        Bank &bank = banks[bankOf(addr)];
+
+        unsigned int latency = config.tCAS;
+        if (result == RowResult::MISS)
+            latency += config.tRCD;
+        else if (result == RowResult::CONFLICT)
+            latency += config.tRP + config.tRCD;
+
+        if (words > 1)
+            latency += (unsigned int)(words - 1) * config.perWordCycles;
+
+        // O barramento de dados inverte de sentido: a leitura espera a escrita assentar
+        bool turnaround = !isWrite && lastWasWrite;
+        if (turnaround)
+            latency += config.tWTR;
+        lastWasWrite = isWrite;
+
+        // Página aberta: a linha continua no row buffer após o acesso
+        bank.open = true;
+        bank.row = rowOf(addr);
+
+        // [METRICA] Row buffer
+        if (stats)
+        {
+            stats->dramAccesses++;
+            stats->dramLatencyCycles += latency;
+            if (result == RowResult::HIT)
+                stats->dramRowHits++;
+            else if (result == RowResult::MISS)
+                stats->dramRowMisses++;
+            else
+                stats->dramRowConflicts++;
+            if (turnaround)
+                stats->dramTurnarounds++;
+        }
+        return latency;
+    }
+
+    RowResult classify(Address addr) const
+    {
+        const Bank &bank = banks[bankOf(addr)];
+        if (!bank.open)
+            return RowResult::MISS;
+        return (bank.row == rowOf(addr)) ? RowResult::HIT : RowResult::CONFLICT;
+    }
+};
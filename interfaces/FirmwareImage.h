@@ -0,0 +1,224 @@
+#pragma once
+#include "Types.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Imagem de firmware com seções (.bin)
+//
+//   Cabeçalho  magic "SIMIMG\0\0", versão, entrada, nº de segmentos, checksum
+//   Tabela     por segmento: endereço de carga, tamanho (palavras), flags, offset no arquivo
+//   Dados      palavras de cada segmento, sem os zeros entre ORGs
+//
+// O checksum (FNV-1a de 64 bits) cobre a tabela e os dados.
+// Arquivos sem o magic são tratados como a imagem crua antiga (tudo a partir de 0).
+namespace SegmentFlag
+{
+    constexpr uint32_t EXEC = 1 << 0;
+    constexpr uint32_t WRITE = 1 << 1;
+}
+
+struct ImageSegment
+{
+    Address load = 0;
+    uint32_t flags = SegmentFlag::EXEC | SegmentFlag::WRITE;
+    std::vector<Word> words;
+};
+
+struct FirmwareImage
+{
+    Address entry = 0;
+    std::vector<ImageSegment> segments;
+
+    static constexpr char MAGIC[8] = {'S', 'I', 'M', 'I', 'M', 'G', '\0', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_BYTES = 8 + 3 * sizeof(uint32_t) + sizeof(uint64_t);
+    static constexpr size_t SEGMENT_ENTRY_BYTES = 4 * sizeof(uint32_t);
+
+    // Uma sequência de zeros menor que isso fica dentro do segmento
+    // (uma entrada na tabela custa 4 palavras)
+    static constexpr size_t MIN_GAP_WORDS = 8;
+
+    // Corta a imagem plana do montador/linker nos buracos de zeros (ORG)
+    static FirmwareImage fromFlat(const std::vector<Word> &flat, Address entry = 0)
+    {
+        FirmwareImage image;
+        image.entry = entry;
+        size_t i = 0;
+        while (i < flat.size())
+        {
+            while (i < flat.size() && flat[i] == 0)
+                i++;
+            if (i == flat.size())
+                break;
+
+            size_t start = i, end = i, zeros = 0;
+            for (; i < flat.size() && zeros < MIN_GAP_WORDS; i++)
+            {
+                if (flat[i] == 0)
+                    zeros++;
+                else
+                {
+                    zeros = 0;
+                    end = i + 1;
+                }
+            }
+            ImageSegment segment;
+            segment.load = (Address)start;
+            segment.words.assign(flat.begin() + start, flat.begin() + end);
+            image.segments.push_back(std::move(segment));
+            i = end;
+        }
+        return image;
+    }
+
+    size_t totalWords() const
+    {
+        size_t total = 0;
+        for (const auto &segment : segments)
+            total += segment.words.size();
+        return total;
+    }
+
+    size_t fileBytes() const { return HEADER_BYTES + segments.size() * SEGMENT_ENTRY_BYTES + totalWords() * sizeof(Word); }
+
+    bool save(const std::string &path) const
+    {
+        // Monta tudo depois do cabeçalho num buffer para calcular o checksum
+        std::vector<unsigned char> body;
+        uint32_t offset = (uint32_t)(HEADER_BYTES + segments.size() * SEGMENT_ENTRY_BYTES);
+        for (const auto &segment : segments)
+        {
+            append(body, segment.load);
+            append(body, (uint32_t)segment.words.size());
+            append(body, segment.flags);
+            append(body, offset);
+            offset += (uint32_t)(segment.words.size() * sizeof(Word));
+        }
+        for (const auto &segment : segments)
+        {
+            const unsigned char *bytes = reinterpret_cast<const unsigned char *>(segment.words.data());
+            body.insert(body.end(), bytes, bytes + segment.words.size() * sizeof(Word));
+        }
+
+        FILE *out = std::fopen(path.c_str(), "wb");
+        if (!out)
+            return false;
+        uint32_t count = (uint32_t)segments.size();
+        uint64_t sum = checksum(body.data(), body.size());
+        std::fwrite(MAGIC, 1, sizeof(MAGIC), out);
+        std::fwrite(&VERSION, sizeof(VERSION), 1, out);
+        std::fwrite(&entry, sizeof(entry), 1, out);
+        std::fwrite(&count, sizeof(count), 1, out);
+        std::fwrite(&sum, sizeof(sum), 1, out);
+        std::fwrite(body.data(), 1, body.size(), out);
+        bool ok = !std::ferror(out);
+        std::fclose(out);
+        return ok;
+    }
+
+    static uint64_t checksum(const unsigned char *data, size_t length) { return fnv1a(data, length); }
+
+private:
+    static void append(std::vector<unsigned char> &out, uint32_t value)
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(value));
+    }
+};
+
+// Leitor da imagem: mapeia o arquivo e aponta os segmentos direto para o
+// mapeamento (nada é copiado até a carga na RAM). O custo é proporcional aos
+// bytes dos segmentos, não ao maior endereço usado.
+class ImageLoader
+{
+public:
+    struct SegmentView
+    {
+        Address load;
+        uint32_t length; // Palavras
+        uint32_t flags;
+        const Word *words;
+    };
+
+private:
+    MappedFile file;
+    std::vector<SegmentView> views;
+    Address entryPoint = 0;
+    bool raw = false;
+    std::string lastError;
+
+public:
+    bool open(const std::string &path)
+    {
+        views.clear();
+        entryPoint = 0;
+        raw = false;
+        if (!file.open(path))
+            return fail("Firmware nao encontrado: " + path);
+
+        const char *data = file.view().data();
+        size_t size = file.size();
+
+        // Formato antigo: palavras cruas a partir do endereço 0
+        if (size < FirmwareImage::HEADER_BYTES || std::memcmp(data, FirmwareImage::MAGIC, sizeof(FirmwareImage::MAGIC)) != 0)
+        {
+            raw = true;
+            if (size >= sizeof(Word))
+                views.push_back({0, (uint32_t)(size / sizeof(Word)), SegmentFlag::EXEC | SegmentFlag::WRITE,
+                                 reinterpret_cast<const Word *>(data)});
+            return true;
+        }
+
+        uint32_t version = 0, count = 0;
+        uint64_t sum = 0;
+        std::memcpy(&version, data + 8, sizeof(version));
+        std::memcpy(&entryPoint, data + 12, sizeof(entryPoint));
+        std::memcpy(&count, data + 16, sizeof(count));
+        std::memcpy(&sum, data + 20, sizeof(sum));
+
+        if (version != FirmwareImage::VERSION)
+            return fail("Versao de imagem nao suportada: " + std::to_string(version));
+        size_t tableEnd = FirmwareImage::HEADER_BYTES + (size_t)count * FirmwareImage::SEGMENT_ENTRY_BYTES;
+        if (tableEnd > size)
+            return fail("Tabela de segmentos truncada");
+        const unsigned char *body = reinterpret_cast<const unsigned char *>(data) + FirmwareImage::HEADER_BYTES;
+        if (FirmwareImage::checksum(body, size - FirmwareImage::HEADER_BYTES) != sum)
+            return fail("Checksum invalido (imagem corrompida)");
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t entry[4];
+            std::memcpy(entry, data + FirmwareImage::HEADER_BYTES + i * FirmwareImage::SEGMENT_ENTRY_BYTES, sizeof(entry));
+            uint32_t offset = entry[3];
+            if (offset % sizeof(Word) != 0 || offset < tableEnd || offset + (size_t)entry[1] * sizeof(Word) > size)
+                return fail("Segmento " + std::to_string(i) + " fora do arquivo");
+            views.push_back({entry[0], entry[1], entry[2], reinterpret_cast<const Word *>(data + offset)});
+        }
+        return true;
+    }
+
+    const std::vector<SegmentView> &segments() const { return views; }
+    Address entry() const { return entryPoint; }
+    bool isRaw() const { return raw; }
+    const std::string &error() const { return lastError; }
+
+    size_t totalWords() const
+    {
+        size_t total = 0;
+        for (const auto &view : views)
+            total += view.length;
+        return total;
+    }
+
+private:
+    bool fail(const std::string &message)
+    {
+        lastError = message;
+        views.clear();
+        return false;
+    }
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a de 64 bits: rápido e suficiente para detectar mudanças/corrupção.
+// Usado no checksum da imagem (.bin) e no hash do fonte dos objetos (.obj).
+inline uint64_t fnv1a(const void *data, size_t length)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
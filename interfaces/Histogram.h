@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Histograma log-linear (estilo HDR) para latências em ciclos.
+// Valores abaixo de 2^SUB_BITS ficam exatos; acima, cada potência de 2 é
+// dividida em 2^SUB_BITS faixas iguais (erro relativo <= 1/32). Registrar é
+// O(1): um clz, um shift e um incremento.
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+
+private:
+    std::vector<uint64_t> counts; // Cresce até o maior bucket usado
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+
+public:
+    void record(uint64_t value)
+    {
+        size_t index = bucketIndex(value);
+        if (index >= counts.size())
+            counts.resize(index + 1, 0);
+        counts[index]++;
+        total++;
+        sum += value;
+        if (value > maxValue)
+            maxValue = value;
+    }
+
+    void merge(const LatencyHistogram &other)
+    {
+        if (other.counts.size() > counts.size())
+            counts.resize(other.counts.size(), 0);
+        for (size_t i = 0; i < other.counts.size(); i++)
+            counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        if (other.maxValue > maxValue)
+            maxValue = other.maxValue;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total == 0 ? 0.0 : (double)sum / total; }
+
+    // Menor valor v tal que pelo menos p% das amostras são <= v (limite superior do bucket)
+    uint64_t percentile(double p) const
+    {
+        if (total == 0)
+            return 0;
+        uint64_t rank = (uint64_t)(p / 100.0 * total + 0.999999);
+        if (rank == 0)
+            rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+                return std::min(bucketHigh(i), maxValue);
+        }
+        return maxValue;
+    }
+
+    static size_t bucketIndex(uint64_t value)
+    {
+        if (value < SUB_COUNT)
+            return (size_t)value;
+        unsigned msb = 63 - (unsigned)__builtin_clzll(value);
+        unsigned shift = msb - SUB_BITS;
+        return (size_t)((shift + 1) * SUB_COUNT + ((value >> shift) - SUB_COUNT));
+    }
+
+    static uint64_t bucketLow(size_t index)
+    {
+        if (index < 2 * SUB_COUNT)
+            return index;
+        unsigned shift = (unsigned)(index / SUB_COUNT) - 1;
+        return (SUB_COUNT + index % SUB_COUNT) << shift;
+    }
+
+    static uint64_t bucketHigh(size_t index)
+    {
+        if (index < 2 * SUB_COUNT)
+            return index;
+        unsigned shift = (unsigned)(index / SUB_COUNT) - 1;
+        return bucketLow(index) + (1ULL << shift) - 1;
+    }
+
+    // --- Exportação (texto, uma linha): total soma max índice:contagem ... ---
+    // Só os buckets não vazios; somar dois arquivos = somar os buckets.
+    void write(FILE *out, const char *name) const
+    {
+        std::fprintf(out, "%s %llu %llu %llu", name, (unsigned long long)total, (unsigned long long)sum,
+                     (unsigned long long)maxValue);
+        for (size_t i = 0; i < counts.size(); i++)
+        {
+            if (counts[i] != 0)
+                std::fprintf(out, " %zu:%llu", i, (unsigned long long)counts[i]);
+        }
+        std::fprintf(out, "\n");
+    }
+
+    // Lê o que vem depois do nome na linha
+    bool parse(const std::string &fields)
+    {
+        *this = LatencyHistogram();
+        unsigned long long t = 0, s = 0, m = 0;
+        int consumed = 0;
+        if (std::sscanf(fields.c_str(), "%llu %llu %llu%n", &t, &s, &m, &consumed) != 3)
+            return false;
+        const char *cursor = fields.c_str() + consumed;
+        size_t index;
+        unsigned long long value;
+        int used = 0;
+        while (std::sscanf(cursor, " %zu:%llu%n", &index, &value, &used) == 2)
+        {
+            if (index > 64 * SUB_COUNT)
+                return false;
+            if (index >= counts.size())
+                counts.resize(index + 1, 0);
+            counts[index] += value;
+            cursor += used;
+        }
+        total = t;
+        sum = s;
+        maxValue = m;
+        return true;
+    }
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Types.h"
+#include <cstddef>
 
 // Interface pura (classe abstrata em C++)
 class IMemoryDevice
@@ -10,4 +11,27 @@ public:
     // Métodos virtuais puros
     virtual Word read(Address addr) const = 0;
     virtual void write(Address addr, Word value) = 0;
-};
\ No newline at end of file
+
+    // --- Transferência em Bloco (Burst) ---
+    // Usado para preencher linhas de cache e, no futuro, DMA.
+    // Retornam o custo do burst em ciclos (0 = dispositivo sem modelo de tempo).
+    // A implementação padrão cai no acesso palavra a palavra; dispositivos
+    // com memória contígua (Ram) sobrescrevem com uma cópia única.
+    virtual unsigned int readBlock(Address addr, Word *dst, size_t count) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = read(addr + i);
+        }
+        return 0;
+    }
+
+    virtual unsigned int writeBlock(Address addr, const Word *src, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            write(addr + i, src[i]);
+        }
+        return 0;
+    }
+};
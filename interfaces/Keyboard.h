@@ -1,6 +1,7 @@
 #pragma once
 #include "IMemoryDevice.h"
 #include "PIC.h"
+#include <functional>
 #include <queue>
 #include <iostream>
 #include <string>
@@ -18,19 +19,44 @@ private:
     // Ponteiro para o relógio global (para métricas de latência)
     unsigned long long *globalCycle;
 
+    // Sem terminal: as teclas vêm só de feed() (benchmarks, entrada roteirizada)
+    bool interactive;
+    bool paused = false; // Replay da viagem no tempo: o terminal espera
+    bool externalInput = false; // Outro thread lê o terminal e entrega via feed() (--quantum)
+
+    // Opcional: vê cada tecla que entra na fila (log de entrada do replay)
+    std::function<void(char)> keyListener;
+
 public:
     // Construtor atualizado para receber o ponteiro de ciclos
-    Keyboard(PIC *interruptController, unsigned long long *cyclePtr)
-        : pic(interruptController), globalCycle(cyclePtr)
+    Keyboard(PIC *interruptController, unsigned long long *cyclePtr, bool useTerminal = true)
+        : pic(interruptController), globalCycle(cyclePtr), interactive(useTerminal)
     {
-        enableRawMode();
+        if (interactive)
+            enableRawMode();
     }
 
     ~Keyboard()
     {
-        disableRawMode();
+        if (interactive)
+            disableRawMode();
+    }
+
+    // Enfileira teclas como se tivessem sido digitadas
+    void feed(const std::string &keys)
+    {
+        for (char c : keys)
+            push(c);
     }
 
+    void setKeyListener(std::function<void(char)> listener) { keyListener = std::move(listener); }
+    void setPaused(bool value) { paused = value; }
+    void setExternalInput(bool value) { externalInput = value; }
+
+    // Teclas ainda não lidas pela CPU (estado do checkpoint)
+    const std::queue<char> &pending() const { return internalBuffer; }
+    void setPending(const std::queue<char> &keys) { internalBuffer = keys; }
+
     // --- Configuração do Terminal (Raw Mode) ---
     void enableRawMode()
     {
@@ -56,27 +82,8 @@ public:
     // --- Tick do Hardware ---
     void tick()
     {
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(STDIN_FILENO, &fds);
-
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = 0; // Não bloqueante
-
-        int ret = select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv);
-
-        if (ret > 0)
-        {
-            char buffer[1];
-            // Usa ::read global para evitar conflito de nome
-            int bytesRead = ::read(STDIN_FILENO, buffer, 1);
-
-            if (bytesRead > 0)
-            {
-                internalBuffer.push(buffer[0]);
-            }
-        }
+        if (interactive && !paused && !externalInput)
+            pollTerminal();
 
         // Se tem dados e o PIC não está ocupado, pede IRQ
         if (!internalBuffer.empty() && !pic->isPending())
@@ -110,4 +117,36 @@ public:
     }
 
     void write(Address addr, Word value) override {}
-};
\ No newline at end of file
+
+    // Lê uma tecla do terminal sem bloquear (false se não há nada)
+    static bool readTerminal(char &c)
+    {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(STDIN_FILENO, &fds);
+
+        struct timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 0; // Não bloqueante
+
+        if (select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) <= 0)
+            return false;
+        // Usa ::read global para evitar conflito de nome
+        return ::read(STDIN_FILENO, &c, 1) > 0;
+    }
+
+private:
+    void push(char c)
+    {
+        internalBuffer.push(c);
+        if (keyListener)
+            keyListener(c);
+    }
+
+    void pollTerminal()
+    {
+        char c;
+        if (readTerminal(c))
+            push(c);
+    }
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include "ObjectFile.h"
+#include "Colors.h"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Junta objetos numa imagem plana.
+//  1. Seções absolutas (ORG) ficam no endereço pedido; sobreposição é erro.
+//  2. Seções relocáveis entram na ordem dos objetos, no primeiro espaço livre
+//     a partir do fim da anterior (a primeira começa em 0 = ponto de entrada).
+//  3. Cada relocação recebe o endereço final do label nos 23 bits do operando.
+class Linker
+{
+private:
+    struct Placement
+    {
+        Address start;
+        Address end; // Exclusivo
+        size_t object;
+        size_t section;
+    };
+
+    std::vector<Placement> placements;
+    std::vector<std::vector<Address>> sectionBase; // [objeto][seção]
+
+public:
+    // 'names' só serve para as mensagens de erro
+    bool link(const std::vector<ObjectFile> &objects, const std::vector<std::string> &names,
+              std::vector<Word> &image)
+    {
+        placements.clear();
+        sectionBase.assign(objects.size(), std::vector<Address>());
+        bool ok = true;
+
+        // --- 1. Seções absolutas ---
+        for (size_t o = 0; o < objects.size(); o++)
+        {
+            sectionBase[o].assign(objects[o].sections.size(), 0);
+            for (size_t s = 0; s < objects[o].sections.size(); s++)
+            {
+                const ObjectSection &section = objects[o].sections[s];
+                if (!section.absolute || section.words.empty())
+                    continue;
+                Placement placed{section.org, section.org + (Address)section.words.size(), o, s};
+                const Placement *clash = overlap(placed.start, placed.end);
+                if (clash)
+                {
+                    std::cerr << Color::RED << "[LINK] ORG " << section.org << " de " << names[o]
+                              << " sobrepoe " << names[clash->object] << " (" << clash->start << ".." << clash->end - 1 << ")"
+                              << Color::RESET << std::endl;
+                    ok = false;
+                    continue;
+                }
+                sectionBase[o][s] = section.org;
+                placements.push_back(placed);
+            }
+        }
+
+        // --- 2. Seções relocáveis (first fit, em ordem) ---
+        Address cursor = 0;
+        for (size_t o = 0; o < objects.size(); o++)
+        {
+            for (size_t s = 0; s < objects[o].sections.size(); s++)
+            {
+                const ObjectSection &section = objects[o].sections[s];
+                if (section.absolute)
+                    continue;
+                Address length = (Address)section.words.size();
+                Address start = cursor;
+                const Placement *clash;
+                while (length > 0 && (clash = overlap(start, start + length)) != nullptr)
+                    start = clash->end;
+                sectionBase[o][s] = start;
+                if (length > 0)
+                {
+                    placements.push_back({start, start + length, o, s});
+                    cursor = start + length;
+                }
+            }
+        }
+
+        // --- 3. Tabela de símbolos global ---
+        std::unordered_map<std::string, Address> symbols;
+        std::unordered_map<std::string, size_t> owner;
+        for (size_t o = 0; o < objects.size(); o++)
+        {
+            for (const auto &symbol : objects[o].symbols)
+            {
+                Address address = sectionBase[o][symbol.section] + symbol.offset;
+                if (!symbols.emplace(symbol.name, address).second)
+                {
+                    std::cerr << Color::RED << "[LINK] Label duplicado: " << symbol.name << " (" << names[owner[symbol.name]]
+                              << " e " << names[o] << ")" << Color::RESET << std::endl;
+                    ok = false;
+                    continue;
+                }
+                owner[symbol.name] = o;
+            }
+        }
+
+        // --- 4. Imagem + relocações ---
+        Address size = 0;
+        for (const auto &placed : placements)
+            size = std::max(size, placed.end);
+        image.assign(size, 0); // Buracos entre seções = 0 (HALT/NOP)
+        for (const auto &placed : placements)
+        {
+            const std::vector<Word> &words = objects[placed.object].sections[placed.section].words;
+            std::copy(words.begin(), words.end(), image.begin() + placed.start);
+        }
+
+        for (size_t o = 0; o < objects.size(); o++)
+        {
+            for (const auto &reloc : objects[o].relocations)
+            {
+                auto it = symbols.find(reloc.symbol);
+                if (it == symbols.end())
+                {
+                    std::cerr << Color::RED << "[LINK] Label nao encontrado: " << reloc.symbol << " (em " << names[o] << ")"
+                              << Color::RESET << std::endl;
+                    ok = false;
+                    continue;
+                }
+                Address at = sectionBase[o][reloc.section] + reloc.offset;
+                image[at] = (image[at] & ~0x7FFFFFu) | (it->second & 0x7FFFFF);
+            }
+        }
+        return ok;
+    }
+
+private:
+    const Placement *overlap(Address start, Address end) const
+    {
+        for (const auto &placed : placements)
+        {
+            if (start < placed.end && placed.start < end)
+                return &placed;
+        }
+        return nullptr;
+    }
+};
@@ -0,0 +1,643 @@
+#pragma once
+#include "Types.h"
+#include "Ram.h"
+#include "Cache.h"
+#include "PIC.h"
+#include "Keyboard.h"
+#include "Display.h"
+#include "DisplaySink.h"
+#include "SystemBus.h"
+#include "CPU.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Prefetcher.h"
+#include "VictimCache.h"
+#include "WriteBuffer.h"
+#include "Pipeline.h"
+#include "BranchPredictor.h"
+#include "OutOfOrder.h"
+#include "Mmu.h"
+#include "FirmwareImage.h"
+#include "Breakpoints.h"
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Máquina completa como objeto: dona de RAM, Cache, PIC, teclado, display,
+// barramento, CPU e dos modelos opcionais. É o que o 'run' e o 'bench' usam,
+// e pode ser incluída por ferramentas próprias (vários objetos por processo,
+// sem estado global e, por padrão, sem tocar no terminal).
+
+// Configuração do hardware (as mesmas opções de linha de comando do 'run')
+struct MachineConfig
+{
+    std::string prefetch = "none"; // none|next[:N]|stride|stream
+    size_t writeBufferDepth = 0;   // 0 = STORE síncrono
+    size_t victimEntries = 0;      // 0 = sem Victim Cache
+    bool pipeline = false;         // Modelo de 5 estágios
+    bool forwarding = true;
+    std::string branchPredictor;   // static|bimodal|gshare|tournament (liga o pipeline)
+    size_t btbEntries = 16;
+    size_t rasDepth = 8;
+    unsigned int oooWidth = 0;     // Núcleo fora de ordem de largura W (0 = desligado)
+    size_t robSize = 64;
+    size_t lsqSize = 16;
+    bool mmu = false;              // MMU com paginação entre CPU e barramento
+    MmuConfig tlb;
+    bool useTerminal = false;      // Teclado lê o terminal (modo raw); senão só feedKeys()
+};
+
+// Cria o preditor de direção conforme a configuração
+inline BranchPredictor *makeBranchPredictor(const std::string &spec)
+{
+    if (spec == "bimodal")
+        return new BimodalPredictor(256);
+    if (spec == "gshare")
+        return new GsharePredictor(256, 8);
+    if (spec == "tournament")
+        return new TournamentPredictor(256);
+    if (spec == "static-taken")
+        return new StaticPredictor(true);
+    if (spec != "static")
+        std::cerr << Color::YELLOW << "[INFO] Preditor desconhecido: " << spec << " (usando static)" << Color::RESET << std::endl;
+    return new StaticPredictor(false);
+}
+
+// Cria o prefetcher conforme a configuração (nullptr = só demanda)
+inline std::unique_ptr<Prefetcher> makePrefetcher(const std::string &spec, size_t blockSize)
+{
+    if (spec.compare(0, 4, "next") == 0)
+    {
+        size_t degree = 1;
+        size_t colon = spec.find(':');
+        if (colon != std::string::npos)
+            degree = std::max(1, std::atoi(spec.c_str() + colon + 1));
+        return std::unique_ptr<Prefetcher>(new NextLinePrefetcher(degree));
+    }
+    if (spec == "stride")
+        return std::unique_ptr<Prefetcher>(new StridePrefetcher(16, blockSize));
+    if (spec == "stream")
+        return std::unique_ptr<Prefetcher>(new StreamBuffer(4));
+    if (spec != "none")
+        std::cerr << Color::YELLOW << "[INFO] Prefetcher desconhecido: " << spec << " (desligado)" << Color::RESET << std::endl;
+    return nullptr;
+}
+
+// Acesso observado por um watchpoint de memória
+struct MemoryAccess
+{
+    Address addr;
+    Word value;
+    bool isWrite;
+    Address pc; // Instrução que fez o acesso
+};
+
+namespace WatchKind
+{
+    const uint8_t READ = 1 << 0;
+    const uint8_t WRITE = 1 << 1;
+}
+
+// Camada entre a CPU e o barramento que avisa os watchpoints.
+// Só entra no caminho da CPU quando existe algum watchpoint.
+class WatchBus : public IMemoryDevice
+{
+public:
+    struct Watch
+    {
+        int id;
+        Address low, high; // Faixa [low, high]
+        uint8_t kinds;
+        std::function<void(const MemoryAccess &)> callback;
+    };
+
+private:
+    // Uma entrada por página de 64 palavras: OU dos tipos vigiados nela.
+    // Acesso fora de página vigiada custa um load e um AND.
+    static constexpr unsigned PAGE_BITS = 6;
+    static constexpr size_t PAGES = (1u << 16) >> PAGE_BITS;
+
+    IMemoryDevice *inner;
+    const Address *pc;
+    std::vector<Watch> watches;
+    std::vector<uint8_t> pageKinds = std::vector<uint8_t>(PAGES, 0);
+
+public:
+    WatchBus(IMemoryDevice *target, const Address *currentPC) : inner(target), pc(currentPC) {}
+
+    void add(Watch watch)
+    {
+        watches.push_back(std::move(watch));
+        rebuild();
+    }
+
+    // Retorna true se ainda sobrou algum watchpoint
+    bool remove(int id)
+    {
+        watches.erase(std::remove_if(watches.begin(), watches.end(), [id](const Watch &w)
+                                     { return w.id == id; }),
+                      watches.end());
+        rebuild();
+        return !watches.empty();
+    }
+
+    const std::vector<Watch> &all() const { return watches; }
+
+    Word read(Address addr) const override
+    {
+        Word value = inner->read(addr);
+        notify(addr, &value, 1, false);
+        return value;
+    }
+
+    void write(Address addr, Word value) override
+    {
+        inner->write(addr, value);
+        notify(addr, &value, 1, true);
+    }
+
+    unsigned int readBlock(Address addr, Word *dst, size_t count) const override
+    {
+        unsigned int cycles = inner->readBlock(addr, dst, count);
+        notify(addr, dst, count, false);
+        return cycles;
+    }
+
+    unsigned int writeBlock(Address addr, const Word *src, size_t count) override
+    {
+        unsigned int cycles = inner->writeBlock(addr, src, count);
+        notify(addr, src, count, true);
+        return cycles;
+    }
+
+private:
+    static size_t pageOf(Address addr) { return std::min((size_t)(addr >> PAGE_BITS), PAGES - 1); }
+
+    void rebuild()
+    {
+        std::fill(pageKinds.begin(), pageKinds.end(), 0);
+        for (const Watch &watch : watches)
+        {
+            for (size_t page = pageOf(watch.low); page <= pageOf(watch.high); page++)
+                pageKinds[page] |= watch.kinds;
+        }
+    }
+
+    // Um aviso por palavra da faixa tocada
+    void notify(Address addr, const Word *values, size_t count, bool isWrite) const
+    {
+        if (count == 0)
+            return;
+        uint8_t kind = isWrite ? WatchKind::WRITE : WatchKind::READ;
+        Address last = addr + (Address)count - 1;
+        bool watched = false;
+        for (size_t page = pageOf(addr); page <= pageOf(last) && !watched; page++)
+            watched = (pageKinds[page] & kind) != 0;
+        if (!watched)
+            return;
+        for (const Watch &watch : watches)
+        {
+            if (!(watch.kinds & kind) || watch.high < addr || watch.low > last)
+                continue;
+            Address from = std::max(addr, watch.low), to = std::min(last, watch.high);
+            for (Address a = from; a <= to; a++)
+                watch.callback({a, values[a - addr], isWrite, *pc});
+        }
+    }
+};
+
+// Por que runUntil/stepN pararam
+enum class StopReason
+{
+    HALTED,     // CPU executou HALT
+    CYCLE,      // Chegou no ciclo pedido
+    PC,         // Próxima instrução está no PC pedido
+    BREAKPOINT, // Breakpoint armado (ver breakpoints().lastHit())
+    STOPPED,    // Alguém chamou stop() (ex.: de um watchpoint)
+    STEP_LIMIT  // Acabou o limite de passos
+};
+
+// Condição de parada do runUntil
+struct StopCondition
+{
+    enum Kind
+    {
+        AT_CYCLE,
+        AT_PC,
+        AT_HALT
+    } kind = AT_HALT;
+    unsigned long long value = 0;
+
+    static StopCondition cycle(unsigned long long target) { return {AT_CYCLE, target}; }
+    static StopCondition pc(Address target) { return {AT_PC, target}; }
+    static StopCondition halt() { return {AT_HALT, 0}; }
+};
+
+// Observador do início de cada passo (checkpoints e replay da viagem no tempo)
+class IStepHook
+{
+public:
+    virtual ~IStepHook() = default;
+    virtual void beforeStep() = 0;
+};
+
+// Tudo o que muda durante a execução, menos o conteúdo da RAM
+// (que o checkpoint guarda em páginas)
+struct MachineState
+{
+    unsigned long long steps;
+    Stats stats;
+    CPU::State cpu;
+    std::vector<CacheLine> cacheLines;
+    PIC pic;
+    DramController dram;
+    std::queue<char> keys;
+    std::string displayText;
+};
+
+class Machine
+{
+private:
+    MachineConfig config;
+    Stats statistics;
+    Tracer *tracer;
+
+    Ram ram;
+    Cache cache;
+    PIC pic;
+    Keyboard keyboard;
+
+    // Display: o sink injetado recebe o texto formatado; sem sink, descarta
+    NullSink nullSink;
+    Display display;
+    SystemBus bus;
+
+    std::unique_ptr<Mmu> mmu;
+    std::unique_ptr<VictimCache> victimCache;
+    std::unique_ptr<WriteBuffer> writeBuffer;
+    std::unique_ptr<BranchUnit> branchUnit;
+    std::unique_ptr<ITimingModel> timingModel;
+    std::unique_ptr<Prefetcher> prefetcher;
+
+    IMemoryDevice *cpuBus; // Barramento ou MMU (o que a CPU enxerga)
+    std::unique_ptr<WatchBus> watchBus;
+    int nextWatchId = 1;
+    BreakpointSet breaks;
+
+    CPU cpu;
+
+    bool stopRequested = false;
+    std::string lastError;
+
+    unsigned long long steps = 0; // Passos iniciados (o relógio pode andar mais que 1 por passo)
+    IStepHook *stepHook = nullptr;
+
+public:
+    Machine(const MachineConfig &machineConfig = MachineConfig(), Tracer *tracer = nullptr, DisplaySink *sink = nullptr)
+        : config(machineConfig),
+          tracer(tracer),
+          ram(&statistics),
+          cache(&ram, &statistics, 8, 4, tracer),
+          pic(&statistics),
+          keyboard(&pic, &statistics.totalCycles, config.useTerminal),
+          display(sink ? sink : &nullSink),
+          bus(&cache, &keyboard, &display),
+          cpuBus(&bus),
+          cpu(&bus, &pic, &statistics, tracer)
+    {
+        // MMU opcional entre a CPU e o barramento (tradução só em modo usuário)
+        if (config.mmu)
+        {
+            mmu.reset(new Mmu(&bus, &pic, &statistics, config.tlb));
+            cpuBus = mmu.get();
+            cpu.setBus(cpuBus);
+            cpu.setMmu(mmu.get());
+            statistics.mmuConfig = std::to_string(config.tlb.tlbSets) + " conjuntos x " + std::to_string(config.tlb.tlbWays) + " vias";
+        }
+
+        if (config.victimEntries > 0)
+        {
+            victimCache.reset(new VictimCache(config.victimEntries, 4, &statistics));
+            cache.setVictimCache(victimCache.get());
+        }
+
+        if (config.writeBufferDepth > 0)
+        {
+            writeBuffer.reset(new WriteBuffer(&ram, &statistics, config.writeBufferDepth, 4));
+            cache.setWriteBuffer(writeBuffer.get());
+        }
+
+        // Modelo de tempo opcional: com ele, o relógio inclui stalls e bolhas
+        if (!config.branchPredictor.empty())
+        {
+            branchUnit.reset(new BranchUnit(makeBranchPredictor(config.branchPredictor), &statistics,
+                                            config.btbEntries, config.rasDepth));
+            statistics.branchPredictor = branchUnit->name() + " + BTB(" + std::to_string(config.btbEntries) +
+                                         ") + RAS(" + std::to_string(config.rasDepth) + ")";
+        }
+        if (config.oooWidth > 0)
+        {
+            OutOfOrderConfig ooo;
+            ooo.fetchWidth = ooo.issueWidth = ooo.commitWidth = config.oooWidth;
+            ooo.robSize = config.robSize;
+            ooo.lsqSize = config.lsqSize;
+            OutOfOrderModel *model = new OutOfOrderModel(&statistics, ooo);
+            model->setBranchUnit(branchUnit.get());
+            timingModel.reset(model);
+        }
+        else if (config.pipeline || branchUnit)
+        {
+            PipelineModel *model = new PipelineModel(&statistics, config.forwarding);
+            model->setBranchUnit(branchUnit.get());
+            timingModel.reset(model);
+        }
+        if (timingModel)
+        {
+            cpu.setTimingModel(timingModel.get());
+            statistics.timingModel = timingModel->name();
+            if (writeBuffer)
+                writeBuffer->setClockIncludesStalls(true);
+        }
+
+        prefetcher = makePrefetcher(config.prefetch, 4);
+        if (prefetcher)
+            cache.setPrefetcher(prefetcher.get(), cpu.getInstructionPCRef(), ram.size());
+    }
+
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
+
+    // --- Carga ---
+
+    // Imagem do disco (com seções ou crua); o PC vai para a entrada da imagem
+    bool load(const std::string &path)
+    {
+        ImageLoader loader;
+        if (!loader.open(path))
+        {
+            lastError = loader.error();
+            return false;
+        }
+        for (const auto &segment : loader.segments())
+        {
+            if (!loadWords(segment.load, segment.words, segment.length))
+                return false;
+        }
+        cpu.setEntryPoint(loader.entry());
+        return true;
+    }
+
+    bool loadWords(Address addr, const Word *words, size_t count)
+    {
+        if (!ram.loadSegment(addr, words, count))
+        {
+            lastError = "segmento em " + std::to_string(addr) + " nao cabe na RAM";
+            return false;
+        }
+        return true;
+    }
+
+    bool loadImage(const std::vector<Word> &image, Address entry = 0)
+    {
+        if (!loadWords(0, image.data(), image.size()))
+            return false;
+        cpu.setEntryPoint(entry);
+        return true;
+    }
+
+    const std::string &error() const { return lastError; }
+
+    // --- Execução ---
+
+    // Um passo do relógio: teclado e uma instrução (ou a entrada numa ISR).
+    // Com breakpoints armados, usa o motor de depuração da CPU e retorna true
+    // se parou num deles (antes da busca).
+    bool step()
+    {
+        beginStep();
+        if (breaks.empty())
+        {
+            cpu.step();
+            return false;
+        }
+        return cpu.stepUntil(breaks);
+    }
+
+    // Até n passos; retorna quantos rodaram (menos que n no HALT, breakpoint ou stop())
+    unsigned long long stepN(unsigned long long n)
+    {
+        unsigned long long done = 0;
+        stopRequested = false;
+        if (breaks.empty())
+            runLoop<false>(StopCondition::halt(), n, done);
+        else
+            runLoop<true>(StopCondition::halt(), n, done);
+        return done;
+    }
+
+    // Roda até a condição, um HALT, um breakpoint, um stop() ou maxSteps passos
+    StopReason runUntil(const StopCondition &condition, unsigned long long maxSteps = ~0ULL)
+    {
+        unsigned long long done = 0;
+        stopRequested = false;
+        if (breaks.empty())
+            return runLoop<false>(condition, maxSteps, done);
+        return runLoop<true>(condition, maxSteps, done);
+    }
+
+private:
+    // Relógio e teclado do passo; um passo retomado depois de uma parada já os teve
+    void beginStep()
+    {
+        if (cpu.isFetchPending())
+            return;
+        if (stepHook)
+            stepHook->beforeStep();
+        // Com modelo de tempo, quem avança o relógio é o retire da CPU
+        if (!timingModel)
+            statistics.totalCycles++;
+        keyboard.tick();
+        steps++;
+    }
+
+    // Motor escolhido uma vez por chamada: sem breakpoints (e sem parada por
+    // PC) o laço é o mesmo do step() normal. O primeiro passo nunca para, para
+    // que continuar de um ponto de parada saia dele.
+    template <bool Debug>
+    StopReason runLoop(const StopCondition &condition, unsigned long long maxSteps, unsigned long long &done)
+    {
+        bool atPc = condition.kind == StopCondition::AT_PC;
+        Address target = (Address)condition.value;
+        for (;; done++)
+        {
+            if (cpu.isHalted())
+                return StopReason::HALTED;
+            if (condition.kind == StopCondition::AT_CYCLE && statistics.totalCycles >= condition.value)
+                return StopReason::CYCLE;
+            if (stopRequested)
+                return StopReason::STOPPED;
+            if (done == maxSteps)
+                return StopReason::STEP_LIMIT;
+
+            beginStep();
+            if (done == 0 || (!Debug && !atPc))
+            {
+                cpu.step();
+                continue;
+            }
+            bool pcHit = false;
+            auto shouldStop = [&](const Registers &r)
+            {
+                if (atPc && r.getPC() == target)
+                    return pcHit = true;
+                return Debug && breaks(r);
+            };
+            if (cpu.stepUntil(shouldStop))
+                return pcHit ? StopReason::PC : StopReason::BREAKPOINT;
+        }
+    }
+
+public:
+    // Pede para o stepN/runUntil parar depois do passo atual (seguro dentro de callbacks)
+    void stop() { stopRequested = true; }
+
+    // Lê e limpa um stop() pedido fora do stepN/runUntil (ex.: watchpoint durante step())
+    bool consumeStop()
+    {
+        bool requested = stopRequested;
+        stopRequested = false;
+        return requested;
+    }
+
+    // Passo sem breakpoints (replay da viagem no tempo)
+    void stepRaw()
+    {
+        beginStep();
+        cpu.step();
+    }
+
+    // Inicia o passo e para antes da busca, como num breakpoint
+    void stepToFetch()
+    {
+        beginStep();
+        cpu.stepUntil([](const Registers &)
+                      { return true; });
+    }
+
+    // --- Checkpoints ---
+    // Só a configuração padrão: modelos de tempo, MMU, prefetcher, Victim Cache
+    // e buffer de escrita têm estado próprio que o checkpoint não guarda.
+    bool supportsCheckpoints() const
+    {
+        return !timingModel && !mmu && !prefetcher && !victimCache && !writeBuffer;
+    }
+
+    void setStepHook(IStepHook *hook) { stepHook = hook; }
+    unsigned long long stepCount() const { return steps; }
+
+    MachineState saveState() const
+    {
+        return {steps, statistics, cpu.saveState(), cache.saveLines(), pic,
+                ram.getDram(), keyboard.pending(), display.pendingText()};
+    }
+
+    void restoreState(const MachineState &state)
+    {
+        steps = state.steps;
+        statistics = state.stats;
+        cpu.restoreState(state.cpu);
+        cache.restoreLines(state.cacheLines);
+        pic = state.pic;
+        ram.getDram() = state.dram;
+        keyboard.setPending(state.keys);
+        display.setPendingText(state.displayText);
+        stopRequested = false;
+    }
+
+    Ram &getRam() { return ram; }
+
+    // Drena o modelo de tempo e o buffer de escrita (antes de ler o relatório)
+    void finish()
+    {
+        if (timingModel)
+            timingModel->finish();
+        cache.flushWrites();
+    }
+
+    // --- Dispositivos ---
+
+    // Teclas entram na fila do teclado como se tivessem sido digitadas
+    void feedKeys(const std::string &keys) { keyboard.feed(keys); }
+
+    // Cada linha do display (comando FLUSH), sem cores, vai para o callback
+    void onDisplayLine(std::function<void(const std::string &)> callback) { display.setLineListener(std::move(callback)); }
+
+    // Watchpoint em [low, high]; kinds = WatchKind::READ | WatchKind::WRITE. Retorna o id.
+    // Só acessos a dados disparam: a busca de instrução não passa pela camada.
+    int addWatch(Address low, Address high, uint8_t kinds, std::function<void(const MemoryAccess &)> callback)
+    {
+        if (!watchBus)
+        {
+            watchBus.reset(new WatchBus(cpuBus, cpu.getInstructionPCRef()));
+            cpu.setDataBus(watchBus.get());
+        }
+        watchBus->add({nextWatchId, low, high, kinds, std::move(callback)});
+        return nextWatchId++;
+    }
+
+    // Sem watchpoints, a CPU volta a falar direto com o barramento
+    void removeWatch(int id)
+    {
+        if (!watchBus)
+            return;
+        if (!watchBus->remove(id))
+        {
+            cpu.setDataBus(cpuBus);
+            watchBus.reset();
+        }
+    }
+
+    // Breakpoints de PC/condição: com a lista vazia, a CPU roda no motor normal
+    BreakpointSet &breakpoints() { return breaks; }
+
+    // --- Inspeção ---
+    const Registers &registers() const { return cpu.getRegisters(); }
+    Stats &stats() { return statistics; }
+    const Stats &stats() const { return statistics; }
+    unsigned long long cycle() const { return statistics.totalCycles; }
+    bool isHalted() const { return cpu.isHalted(); }
+    bool hasTimingModel() const { return timingModel != nullptr; }
+    size_t ramSize() const { return ram.size(); }
+
+    // Lê/escreve a RAM sem passar pela Cache (sem custo e sem estatística).
+    // A leitura vê os STOREs ainda no buffer de escrita; a escrita drena o
+    // buffer antes, senão um STORE antigo sobrescreveria o valor depois.
+    Word peek(Address addr) const
+    {
+        if (addr >= ram.size())
+            return 0;
+        Word pending;
+        return cache.pendingWrite(addr, pending) ? pending : ram.read(addr);
+    }
+    void poke(Address addr, Word value)
+    {
+        if (addr < ram.size())
+        {
+            cache.flushWrites();
+            ram.write(addr, value);
+            cache.patch(addr, value);
+        }
+    }
+
+    // Componentes, para quem precisa ir além (relatórios, trace, etc.)
+    CPU &getCPU() { return cpu; }
+    Cache &getCache() { return cache; }
+    Display &getDisplay() { return display; }
+    SystemBus &getBus() { return bus; }
+    Tracer *getTracer() { return tracer; }
+    Keyboard &getKeyboard() { return keyboard; }
+    const std::string &timingModelName() const { return statistics.timingModel; }
+    Prefetcher *getPrefetcher() const { return prefetcher.get(); }
+};
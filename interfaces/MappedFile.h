@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Arquivo mapeado em memória (somente leitura).
+// Evita copiar o fonte/binário inteiro para buffers do processo: as páginas
+// vêm do page cache do kernel sob demanda.
+class MappedFile
+{
+private:
+    const char *data = nullptr;
+    size_t length = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() { close(); }
+
+    bool open(const std::string &path)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        length = (size_t)info.st_size;
+        if (length > 0)
+        {
+            void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED)
+            {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            // Leitura sequencial: pede read-ahead agressivo ao kernel
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapped);
+        }
+        ::close(fd); // O mapeamento continua válido sem o descritor
+        return true;
+    }
+
+    void close()
+    {
+        if (data)
+            munmap(const_cast<char *>(data), length);
+        data = nullptr;
+        length = 0;
+    }
+
+    std::string_view view() const { return std::string_view(data ? data : "", length); }
+    size_t size() const { return length; }
+};
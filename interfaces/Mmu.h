@@ -0,0 +1,288 @@
+#pragma once
+#include "IMemoryDevice.h"
+#include "Registers.h"
+#include "PIC.h"
+#include "Stats.h"
+#include <vector>
+
+// Parâmetros da MMU
+struct MmuConfig
+{
+    size_t tlbSets = 4; // TLB associativa por conjunto
+    size_t tlbWays = 2;
+};
+
+// MMU entre a CPU e o SystemBus (paginação de um nível).
+//  - Modo kernel: sem tradução (identidade), acesso aos registradores de controle.
+//  - Modo usuário com a MMU ligada: endereço virtual = VPN (6 bits) + offset (6 bits).
+//    A PTE fica na RAM em PTBR + VPN e a TLB guarda as traduções recentes.
+//  - Falha (página ausente, escrita em página só-leitura, página de kernel ou
+//    MMIO de controle) gera IRQ 2 no PIC; a CPU aborta e reinicia a instrução.
+//
+// Formato da PTE: bit 22 = válida, bit 21 = escrita permitida,
+// bit 20 = acessível pelo usuário, bits 0..19 = quadro físico.
+// Tudo cabe no imediato de 23 bits: o kernel monta a PTE com um LOAD #.
+//
+// Registradores de controle (só em modo kernel):
+//   0xD000 PTBR          (escrita/leitura; escrever esvazia a TLB)
+//   0xD001 Liga/desliga  (escrita/leitura; escrever esvazia a TLB)
+//   0xD002 Endereço virtual da última falha (leitura)
+//   0xD003 Causa da última falha (leitura: 1 = ausente, 2 = proteção)
+//   0xD004 Escrever qualquer valor: o próximo RET entra em modo usuário
+//   0xD005 Escrever qualquer valor: esvazia a TLB
+class Mmu : public IMemoryDevice
+{
+public:
+    static const Address CONTROL_BASE = 0xD000;
+    static const Address CONTROL_END = 0xD006;
+    static const unsigned int PAGE_BITS = 6;
+    static const Address PAGE_WORDS = 1u << PAGE_BITS; // 64 palavras
+    static const Address PAGE_ENTRIES = 64;           // Espaço virtual: 4096 palavras
+
+    static const Word PTE_VALID = 1u << 22;
+    static const Word PTE_WRITABLE = 1u << 21;
+    static const Word PTE_USER = 1u << 20;
+    static const Word PTE_FRAME_MASK = (1u << 20) - 1;
+
+    enum FaultCause : Word
+    {
+        FAULT_NONE = 0,
+        FAULT_NOT_PRESENT = 1,
+        FAULT_PROTECTION = 2
+    };
+
+private:
+    struct TlbEntry
+    {
+        bool valid = false;
+        Address vpn = 0;
+        Word pte = 0;
+        unsigned long long lastUse = 0; // LRU dentro do conjunto
+    };
+
+    IMemoryDevice *bus;
+    PIC *pic;
+    Stats *stats;
+    Registers *registers = nullptr; // Modo atual da CPU
+    MmuConfig config;
+
+    std::vector<TlbEntry> tlb; // sets * ways, conjunto i em [i*ways, (i+1)*ways)
+    unsigned long long useClock = 0;
+
+    Address ptbr = 0;
+    bool enabled = false;
+    Address faultAddress = 0;
+    Word faultCause = FAULT_NONE;
+    bool faultPending = false; // Falha na instrução atual (a CPU consome)
+
+public:
+    Mmu(IMemoryDevice *systemBus, PIC *interruptController, Stats *s, MmuConfig cfg = MmuConfig())
+        : bus(systemBus), pic(interruptController), stats(s), config(cfg)
+    {
+        tlb.resize(config.tlbSets * config.tlbWays);
+    }
+
+    void setRegisters(Registers *regs) { registers = regs; }
+
+    // A CPU pergunta depois de cada acesso; true = abortar a instrução
+    bool hasFault() const { return faultPending; }
+    void clearFault() { faultPending = false; }
+
+    Word read(Address addr) const override
+    {
+        Mmu *self = const_cast<Mmu *>(this);
+        if (isKernel())
+        {
+            if (addr >= CONTROL_BASE && addr < CONTROL_END)
+                return readControl(addr);
+            return bus->read(addr);
+        }
+
+        Address physical;
+        if (!self->translate(addr, false, physical))
+            return 0;
+        return bus->read(physical);
+    }
+
+    void write(Address addr, Word value) override
+    {
+        if (isKernel())
+        {
+            if (addr >= CONTROL_BASE && addr < CONTROL_END)
+                writeControl(addr, value);
+            else
+                bus->write(addr, value);
+            return;
+        }
+
+        Address physical;
+        if (translate(addr, true, physical))
+            bus->write(physical, value);
+    }
+
+    // Sem tradução o burst segue inteiro; com tradução, palavra a palavra
+    // (cada palavra pode cair numa página diferente)
+    unsigned int readBlock(Address addr, Word *dst, size_t count) const override
+    {
+        if (isKernel() && (addr + count <= CONTROL_BASE || addr >= CONTROL_END))
+            return bus->readBlock(addr, dst, count);
+        return IMemoryDevice::readBlock(addr, dst, count);
+    }
+
+    unsigned int writeBlock(Address addr, const Word *src, size_t count) override
+    {
+        if (isKernel() && (addr + count <= CONTROL_BASE || addr >= CONTROL_END))
+            return bus->writeBlock(addr, src, count);
+        return IMemoryDevice::writeBlock(addr, src, count);
+    }
+
+    void flushTlb()
+    {
+        for (auto &entry : tlb)
+            entry.valid = false;
+    }
+
+private:
+    bool isKernel() const { return !enabled || registers == nullptr || registers->isPrivileged(); }
+
+    Word readControl(Address addr) const
+    {
+        switch (addr - CONTROL_BASE)
+        {
+        case 0:
+            return ptbr;
+        case 1:
+            return enabled ? 1 : 0;
+        case 2:
+            return faultAddress;
+        case 3:
+            return faultCause;
+        default:
+            return 0;
+        }
+    }
+
+    void writeControl(Address addr, Word value)
+    {
+        switch (addr - CONTROL_BASE)
+        {
+        case 0:
+            ptbr = value;
+            flushTlb();
+            break;
+        case 1:
+            enabled = (value != 0);
+            flushTlb();
+            break;
+        case 4:
+            if (registers)
+                registers->requestUserReturn();
+            break;
+        case 5:
+            flushTlb();
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Tradução em modo usuário: TLB, senão page walk na RAM
+    bool translate(Address vaddr, bool isWrite, Address &physical)
+    {
+        Address vpn = vaddr >> PAGE_BITS;
+        if (vpn >= PAGE_ENTRIES)
+            return fault(vaddr, FAULT_NOT_PRESENT);
+
+        Word pte;
+        if (!lookup(vpn, pte))
+        {
+            pte = walk(vpn);
+            if (!(pte & PTE_VALID))
+                return fault(vaddr, FAULT_NOT_PRESENT);
+            fill(vpn, pte);
+        }
+
+        if (!(pte & PTE_USER) || (isWrite && !(pte & PTE_WRITABLE)))
+            return fault(vaddr, FAULT_PROTECTION);
+
+        physical = ((pte & PTE_FRAME_MASK) << PAGE_BITS) | (vaddr & (PAGE_WORDS - 1));
+
+        // Os registradores de controle nunca ficam visíveis ao usuário
+        if (physical >= CONTROL_BASE && physical < CONTROL_END)
+            return fault(vaddr, FAULT_PROTECTION);
+        return true;
+    }
+
+    bool lookup(Address vpn, Word &pte)
+    {
+        size_t base = (vpn % config.tlbSets) * config.tlbWays;
+        for (size_t way = 0; way < config.tlbWays; way++)
+        {
+            TlbEntry &entry = tlb[base + way];
+            if (entry.valid && entry.vpn == vpn)
+            {
+                entry.lastUse = ++useClock;
+                pte = entry.pte;
+                if (stats)
+                    stats->tlbHits++;
+                return true;
+            }
+        }
+        if (stats)
+            stats->tlbMisses++;
+        return false;
+    }
+
+    void fill(Address vpn, Word pte)
+    {
+        size_t base = (vpn % config.tlbSets) * config.tlbWays;
+        TlbEntry *victim = &tlb[base];
+        for (size_t way = 0; way < config.tlbWays; way++)
+        {
+            TlbEntry &entry = tlb[base + way];
+            if (!entry.valid)
+            {
+                victim = &entry;
+                break;
+            }
+            if (entry.lastUse < victim->lastUse)
+                victim = &entry;
+        }
+        victim->valid = true;
+        victim->vpn = vpn;
+        victim->pte = pte;
+        victim->lastUse = ++useClock;
+    }
+
+    // Page walk: lê a PTE pela hierarquia de memória (Cache/RAM).
+    // Custa 1 ciclo de controle mais a espera do barramento, que já entra em
+    // busWaitCycles e chega aos modelos de tempo como stall de memória.
+    Word walk(Address vpn)
+    {
+        unsigned long long waitBefore = stats ? stats->busWaitCycles : 0;
+        Word pte = bus->read(ptbr + vpn);
+        if (stats)
+        {
+            stats->busWaitCycles++;
+            stats->pageWalks++;
+            stats->pageWalkCycles += stats->busWaitCycles - waitBefore;
+        }
+        return pte;
+    }
+
+    bool fault(Address vaddr, FaultCause cause)
+    {
+        // Só a primeira falha da instrução conta (ela será reexecutada)
+        if (!faultPending)
+        {
+            faultPending = true;
+            faultAddress = vaddr;
+            faultCause = cause;
+            if (stats)
+                stats->pageFaults++;
+            if (pic)
+                pic->requestIRQ(IrqVector::PAGE_FAULT, stats ? stats->totalCycles : 0);
+        }
+        return false;
+    }
+};
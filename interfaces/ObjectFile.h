@@ -0,0 +1,164 @@
+#pragma once
+#include "Types.h"
+#include "Hash.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Trecho contínuo de código de um objeto.
+// A seção inicial (antes de qualquer ORG) é relocável: o linker escolhe onde
+// ela fica. Cada ORG abre uma seção absoluta no endereço pedido.
+struct ObjectSection
+{
+    bool absolute = false;
+    Address org = 0;
+    std::vector<Word> words;
+};
+
+// Label definido no objeto (todos são globais)
+struct ObjectSymbol
+{
+    std::string name;
+    uint32_t section = 0;
+    uint32_t offset = 0;
+};
+
+// Operando que referencia um label: o linker soma o endereço final
+// nos 23 bits do operando da palavra (section, offset)
+struct ObjectRelocation
+{
+    uint32_t section = 0;
+    uint32_t offset = 0;
+    std::string symbol;
+};
+
+// Arquivo objeto do montador (.obj)
+struct ObjectFile
+{
+    uint64_t sourceHash = 0; // Hash do fonte já pré-processado (cache do build incremental)
+    std::vector<ObjectSection> sections;
+    std::vector<ObjectSymbol> symbols;
+    std::vector<ObjectRelocation> relocations;
+
+    static constexpr char MAGIC[8] = {'S', 'I', 'M', 'O', 'B', 'J', '\0', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    // Muda com o fonte e com a versão do formato
+    static uint64_t contentHash(std::string_view text) { return fnv1a(text.data(), text.size()) ^ VERSION; }
+
+    bool save(const std::string &path) const
+    {
+        FILE *out = std::fopen(path.c_str(), "wb");
+        if (!out)
+            return false;
+
+        std::fwrite(MAGIC, 1, sizeof(MAGIC), out);
+        writeU32(out, VERSION);
+        std::fwrite(&sourceHash, sizeof(sourceHash), 1, out);
+
+        writeU32(out, (uint32_t)sections.size());
+        for (const auto &section : sections)
+        {
+            writeU32(out, section.absolute ? 1 : 0);
+            writeU32(out, section.org);
+            writeU32(out, (uint32_t)section.words.size());
+            std::fwrite(section.words.data(), sizeof(Word), section.words.size(), out);
+        }
+
+        writeU32(out, (uint32_t)symbols.size());
+        for (const auto &symbol : symbols)
+        {
+            writeString(out, symbol.name);
+            writeU32(out, symbol.section);
+            writeU32(out, symbol.offset);
+        }
+
+        writeU32(out, (uint32_t)relocations.size());
+        for (const auto &reloc : relocations)
+        {
+            writeU32(out, reloc.section);
+            writeU32(out, reloc.offset);
+            writeString(out, reloc.symbol);
+        }
+
+        bool ok = !std::ferror(out);
+        std::fclose(out);
+        return ok;
+    }
+
+    // 'headerOnly' lê só o hash (para decidir se o cache vale)
+    bool load(const std::string &path, bool headerOnly = false)
+    {
+        FILE *in = std::fopen(path.c_str(), "rb");
+        if (!in)
+            return false;
+
+        char magic[8];
+        uint32_t version = 0;
+        bool ok = std::fread(magic, 1, sizeof(magic), in) == sizeof(magic) &&
+                  std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                  readU32(in, version) && version == VERSION &&
+                  std::fread(&sourceHash, sizeof(sourceHash), 1, in) == 1;
+
+        if (ok && !headerOnly)
+        {
+            sections.clear();
+            symbols.clear();
+            relocations.clear();
+
+            uint32_t count = 0;
+            ok = readU32(in, count);
+            for (uint32_t i = 0; ok && i < count; i++)
+            {
+                ObjectSection section;
+                uint32_t absolute = 0, length = 0;
+                ok = readU32(in, absolute) && readU32(in, section.org) && readU32(in, length);
+                section.absolute = absolute != 0;
+                section.words.resize(length);
+                ok = ok && std::fread(section.words.data(), sizeof(Word), length, in) == length;
+                sections.push_back(std::move(section));
+            }
+
+            ok = ok && readU32(in, count);
+            for (uint32_t i = 0; ok && i < count; i++)
+            {
+                ObjectSymbol symbol;
+                ok = readString(in, symbol.name) && readU32(in, symbol.section) && readU32(in, symbol.offset);
+                symbols.push_back(std::move(symbol));
+            }
+
+            ok = ok && readU32(in, count);
+            for (uint32_t i = 0; ok && i < count; i++)
+            {
+                ObjectRelocation reloc;
+                ok = readU32(in, reloc.section) && readU32(in, reloc.offset) && readString(in, reloc.symbol);
+                relocations.push_back(std::move(reloc));
+            }
+        }
+
+        std::fclose(in);
+        return ok;
+    }
+
+private:
+    static void writeU32(FILE *out, uint32_t value) { std::fwrite(&value, sizeof(value), 1, out); }
+
+    static void writeString(FILE *out, const std::string &text)
+    {
+        writeU32(out, (uint32_t)text.size());
+        std::fwrite(text.data(), 1, text.size(), out);
+    }
+
+    static bool readU32(FILE *in, uint32_t &value) { return std::fread(&value, sizeof(value), 1, in) == 1; }
+
+    static bool readString(FILE *in, std::string &text)
+    {
+        uint32_t length = 0;
+        if (!readU32(in, length) || length > 4096)
+            return false;
+        text.resize(length);
+        return std::fread(&text[0], 1, length, in) == length;
+    }
+};
@@ -0,0 +1,580 @@
+#pragma once
+#include "Types.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Resultado do passo -O (impresso pelo build)
+struct OptimizerReport
+{
+    size_t instructionsBefore = 0;
+    size_t instructionsAfter = 0;
+    size_t loadsRemoved = 0;       // LOAD X logo depois de STORE X
+    size_t loadsRewritten = 0;     // LOAD X trocado por ADD/SUB # (valor já conhecido no ACC)
+    size_t jumpsThreaded = 0;      // Desvio para um JUMP passa a ir direto ao destino final
+    size_t jumpsRemoved = 0;       // JUMP para a instrução seguinte
+    size_t immediatesFolded = 0;   // ADD/SUB # vizinhos juntados num só
+    size_t unreachableRemoved = 0; // Código que nenhum caminho alcança
+
+    size_t saved() const { return instructionsBefore - instructionsAfter; }
+};
+
+// Otimizador peephole + código morto do Assembler (-O).
+// Trabalha sobre as linhas já limpas: monta uma IR de instruções agrupadas
+// em blocos básicos, transforma e devolve o fonte reescrito. O Assembler
+// então refaz os endereços dos labels normalmente nos dois passos.
+//
+// Regras de segurança:
+//  - Endereços >= 0xD000 (MMU, Display, Teclado) são voláteis: nunca são
+//    eliminados nem rastreados. A RAM comum é tratada como não volátil, como
+//    faria um compilador (dados divididos com a ISR devem ficar no MMIO ou
+//    ser relidos depois de um label).
+//  - O início do programa, cada ORG (vetores de interrupção) e labels usados
+//    como dado (LOAD LABEL, SETSRC LABEL...) são raízes: nunca são removidos.
+//  - Desvios com alvo numérico ganham um label sintético, para continuarem
+//    certos quando o código encolhe.
+class PeepholeOptimizer
+{
+private:
+    static const Address VOLATILE_BASE = 0xD000;
+
+    struct IrInstr
+    {
+        std::vector<std::string> labels; // Labels que apontam para esta instrução
+        bool hasOrg = false;             // Um ORG vem logo antes dela
+        Address org = 0;
+        Address address = 0;             // Endereço original (para alvos numéricos)
+        std::string mnemonic;
+        std::string operand; // Texto do operando ("" = sem operando)
+        bool removed = false;
+    };
+
+    struct BasicBlock
+    {
+        size_t begin = 0; // Índices em 'code' (instruções vivas)
+        size_t end = 0;
+        std::vector<size_t> successors;
+        size_t predecessors = 0;
+        bool root = false; // Entrada externa (início, ORG, endereço usado como dado)
+        bool reachable = false;
+    };
+
+    std::vector<IrInstr> code;
+    std::vector<std::string> trailingLabels; // Labels no fim do arquivo
+    std::map<std::string, size_t> labelIndex;
+    OptimizerReport report;
+
+public:
+    std::vector<std::string> optimize(const std::vector<std::string> &lines)
+    {
+        report = OptimizerReport();
+        if (!buildIr(lines))
+            return lines;
+        report.instructionsBefore = code.size();
+
+        threadJumps();
+
+        // Remover código pode expor novos JUMPs para a próxima instrução e vice-versa
+        bool changed = true;
+        while (changed)
+        {
+            changed = removeUnreachable();
+            changed = removeJumpsToNext() || changed;
+        }
+        eliminateRedundantLoads();
+        foldImmediates();
+
+        report.instructionsAfter = liveCount();
+        return emit();
+    }
+
+    const OptimizerReport &getReport() const { return report; }
+
+private:
+    // --- Construção da IR ---
+    bool buildIr(const std::vector<std::string> &lines)
+    {
+        code.clear();
+        trailingLabels.clear();
+        labelIndex.clear();
+
+        std::vector<std::string> pendingLabels;
+        bool pendingOrg = false;
+        Address org = 0;
+        Address address = 0;
+
+        for (const auto &line : lines)
+        {
+            if (line.substr(0, 3) == "ORG")
+            {
+                try
+                {
+                    org = (Address)std::stoi(line.substr(4));
+                }
+                catch (...)
+                {
+                    return false; // Deixa o Assembler reportar o erro
+                }
+                pendingOrg = true;
+                address = org;
+                continue;
+            }
+            if (line.back() == ':')
+            {
+                pendingLabels.push_back(line.substr(0, line.size() - 1));
+                continue;
+            }
+
+            IrInstr instr;
+            std::stringstream ss(line);
+            ss >> instr.mnemonic >> instr.operand;
+            std::transform(instr.mnemonic.begin(), instr.mnemonic.end(), instr.mnemonic.begin(), ::toupper);
+            instr.labels.swap(pendingLabels);
+            instr.hasOrg = pendingOrg;
+            instr.org = org;
+            instr.address = address++;
+            pendingOrg = false;
+            code.push_back(instr);
+        }
+        trailingLabels.swap(pendingLabels);
+
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            for (const auto &label : code[i].labels)
+                labelIndex[label] = i;
+        }
+
+        // Alvos numéricos viram labels sintéticos
+        for (auto &instr : code)
+        {
+            if (!isBranch(instr.mnemonic) || instr.operand.empty() || isSymbol(instr.operand))
+                continue;
+            std::string digits = instr.operand[0] == '#' ? instr.operand.substr(1) : instr.operand;
+            Address target = (Address)std::stoul(digits);
+            size_t index = code.size();
+            for (size_t i = 0; i < code.size(); i++)
+            {
+                if (code[i].address == target)
+                    index = i;
+            }
+            if (index == code.size())
+                return false; // Desvio para fora do código: não dá para relocar com segurança
+            std::string label = "__ADDR_" + std::to_string(target);
+            if (!labelIndex.count(label))
+            {
+                code[index].labels.push_back(label);
+                labelIndex[label] = index;
+            }
+            instr.operand = label;
+        }
+        return true;
+    }
+
+    // --- Jump Threading ---
+    // JUMP/JEQ/CALL para um label cuja instrução é outro JUMP vai direto ao destino final
+    void threadJumps()
+    {
+        for (auto &instr : code)
+        {
+            if (!isBranch(instr.mnemonic) || !labelIndex.count(instr.operand))
+                continue;
+
+            std::string target = instr.operand;
+            size_t hops = 0;
+            while (hops++ < code.size())
+            {
+                const IrInstr &next = code[labelIndex[target]];
+                if (next.mnemonic != "JUMP" || !labelIndex.count(next.operand) || next.operand == target)
+                    break;
+                target = next.operand;
+            }
+            if (target != instr.operand)
+            {
+                instr.operand = target;
+                report.jumpsThreaded++;
+            }
+        }
+    }
+
+    // --- Blocos Básicos ---
+    std::vector<BasicBlock> buildBlocks(std::vector<size_t> &blockOf)
+    {
+        std::vector<size_t> live;
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            if (!code[i].removed)
+                live.push_back(i);
+        }
+
+        std::vector<BasicBlock> blocks;
+        blockOf.assign(code.size(), SIZE_MAX);
+        for (size_t k = 0; k < live.size(); k++)
+        {
+            const IrInstr &instr = code[live[k]];
+            bool leader = blocks.empty() || instr.hasOrg || !instr.labels.empty() ||
+                          endsBlock(code[live[k - 1]].mnemonic);
+            if (leader)
+            {
+                BasicBlock block;
+                block.begin = live[k];
+                block.root = blocks.empty() || instr.hasOrg;
+                blocks.push_back(block);
+            }
+            blocks.back().end = live[k] + 1;
+            blockOf[live[k]] = blocks.size() - 1;
+        }
+
+        // Labels usados como dado viram raízes
+        for (size_t i : live)
+        {
+            const IrInstr &instr = code[i];
+            if (!isBranch(instr.mnemonic) && labelIndex.count(instr.operand))
+            {
+                size_t target = resolve(instr.operand);
+                if (target < code.size())
+                    blocks[blockOf[target]].root = true;
+            }
+        }
+
+        // Arestas
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            const IrInstr &last = code[lastLive(blocks[b])];
+            if (isBranch(last.mnemonic))
+            {
+                size_t target = resolve(last.operand);
+                if (target < code.size())
+                    blocks[b].successors.push_back(blockOf[target]);
+            }
+            bool fallsThrough = last.mnemonic != "JUMP" && last.mnemonic != "RET" && last.mnemonic != "HALT";
+            if (fallsThrough && b + 1 < blocks.size())
+                blocks[b].successors.push_back(b + 1);
+            for (size_t s : blocks[b].successors)
+                blocks[s].predecessors++;
+        }
+        return blocks;
+    }
+
+    // --- Código Inalcançável ---
+    bool removeUnreachable()
+    {
+        std::vector<size_t> blockOf;
+        std::vector<BasicBlock> blocks = buildBlocks(blockOf);
+
+        std::vector<size_t> work;
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            if (blocks[b].root)
+            {
+                blocks[b].reachable = true;
+                work.push_back(b);
+            }
+        }
+        while (!work.empty())
+        {
+            size_t b = work.back();
+            work.pop_back();
+            for (size_t s : blocks[b].successors)
+            {
+                if (!blocks[s].reachable)
+                {
+                    blocks[s].reachable = true;
+                    work.push_back(s);
+                }
+            }
+        }
+
+        bool changed = false;
+        for (const auto &block : blocks)
+        {
+            if (block.reachable)
+                continue;
+            for (size_t i = block.begin; i < block.end; i++)
+            {
+                if (!code[i].removed)
+                {
+                    removeAt(i);
+                    report.unreachableRemoved++;
+                    changed = true;
+                }
+            }
+        }
+        return changed;
+    }
+
+    // --- JUMP para a instrução seguinte ---
+    bool removeJumpsToNext()
+    {
+        bool changed = false;
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            if (code[i].removed || code[i].mnemonic != "JUMP")
+                continue;
+            size_t next = nextLive(i + 1);
+            // Depois de um ORG a próxima instrução não é contígua
+            if (next < code.size() && !code[next].hasOrg && resolve(code[i].operand) == next)
+            {
+                removeAt(i);
+                report.jumpsRemoved++;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // --- LOAD redundante ---
+    // Rastreia "ACC == mem[X] + delta" ao longo de um bloco e do fall-through
+    // para um bloco que só tem esse predecessor. Um LOAD X com delta 0 some;
+    // com delta != 0 vira SUB/ADD # (sem acesso à memória).
+    void eliminateRedundantLoads()
+    {
+        std::vector<size_t> blockOf;
+        std::vector<BasicBlock> blocks = buildBlocks(blockOf);
+
+        bool known = false;
+        std::string knownAddr;
+        int64_t delta = 0;
+
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            bool inherits = b > 0 && !blocks[b].root && blocks[b].predecessors == 1 &&
+                            fallsInto(blocks[b - 1], b);
+            if (!inherits)
+                known = false;
+
+            for (size_t i = blocks[b].begin; i < blocks[b].end; i++)
+            {
+                IrInstr &instr = code[i];
+                if (instr.removed)
+                    continue;
+                const std::string &m = instr.mnemonic;
+                bool addressMode = !instr.operand.empty() && instr.operand[0] != '#';
+
+                if (m == "LOAD" && addressMode)
+                {
+                    if (isVolatile(instr.operand))
+                    {
+                        known = false;
+                        continue;
+                    }
+                    std::string addr = instr.operand;
+                    if (known && knownAddr == addr)
+                    {
+                        if (delta == 0)
+                        {
+                            removeAt(i);
+                            report.loadsRemoved++;
+                        }
+                        else if (delta > -0x7FFFFF && delta < 0x7FFFFF)
+                        {
+                            // mem[X] = ACC - delta
+                            instr.mnemonic = delta > 0 ? "SUB" : "ADD";
+                            instr.operand = "#" + std::to_string(delta > 0 ? delta : -delta);
+                            report.loadsRewritten++;
+                        }
+                    }
+                    known = true;
+                    knownAddr = addr;
+                    delta = 0;
+                }
+                else if (m == "STORE")
+                {
+                    if (isVolatile(instr.operand))
+                        continue; // MMIO não muda o ACC nem a RAM rastreada
+                    known = true;
+                    knownAddr = instr.operand;
+                    delta = 0;
+                }
+                else if ((m == "ADD" || m == "SUB") && !addressMode && !instr.operand.empty())
+                {
+                    int64_t k = immediate(instr.operand);
+                    delta += (m == "ADD") ? k : -k;
+                }
+                else if (m == "JEQ" || m == "JUMP" || m == "SETSRC" || m == "SETDST")
+                {
+                    // Não mexem no ACC nem na memória
+                }
+                else
+                {
+                    // Escreve no ACC ou na memória (pilha, bloco) de forma desconhecida
+                    known = false;
+                }
+            }
+        }
+    }
+
+    // --- ADD/SUB # consecutivos ---
+    // As flags só dependem do ACC final, então "ADD #a; SUB #b" vira um ADD/SUB
+    // só (ou some, se a soma der zero). Só dentro do bloco (sem label no meio).
+    void foldImmediates()
+    {
+        for (size_t i = nextLive(0); i < code.size();)
+        {
+            size_t j = nextLive(i + 1);
+            if (j >= code.size())
+                break;
+            IrInstr &first = code[i];
+            IrInstr &second = code[j];
+            if (!isImmediateArith(first) || !isImmediateArith(second) || second.hasOrg || !second.labels.empty())
+            {
+                i = j;
+                continue;
+            }
+
+            int64_t net = signedImmediate(first) + signedImmediate(second);
+            if (net <= -0x7FFFFF || net >= 0x7FFFFF)
+            {
+                i = j;
+                continue;
+            }
+            report.immediatesFolded++;
+            removeAt(j);
+            if (net == 0)
+            {
+                removeAt(i);
+                i = nextLive(i + 1);
+                continue;
+            }
+            first.mnemonic = net > 0 ? "ADD" : "SUB";
+            first.operand = "#" + std::to_string(net > 0 ? net : -net);
+        }
+    }
+
+    // --- Emissão ---
+    std::vector<std::string> emit() const
+    {
+        std::vector<std::string> out;
+        for (const auto &instr : code)
+        {
+            if (instr.removed)
+                continue;
+            if (instr.hasOrg)
+                out.push_back("ORG " + std::to_string(instr.org));
+            for (const auto &label : instr.labels)
+                out.push_back(label + ":");
+            out.push_back(instr.operand.empty() ? instr.mnemonic : instr.mnemonic + " " + instr.operand);
+        }
+        for (const auto &label : trailingLabels)
+            out.push_back(label + ":");
+        return out;
+    }
+
+    // --- Auxiliares ---
+    // Remove a instrução; labels e ORG passam para a próxima viva
+    void removeAt(size_t i)
+    {
+        code[i].removed = true;
+        size_t next = nextLive(i + 1);
+        if (next < code.size())
+        {
+            IrInstr &target = code[next];
+            target.labels.insert(target.labels.begin(), code[i].labels.begin(), code[i].labels.end());
+            if (code[i].hasOrg && !target.hasOrg)
+            {
+                target.hasOrg = true;
+                target.org = code[i].org;
+            }
+            for (const auto &label : code[i].labels)
+                labelIndex[label] = next;
+        }
+        else
+        {
+            trailingLabels.insert(trailingLabels.begin(), code[i].labels.begin(), code[i].labels.end());
+            for (const auto &label : code[i].labels)
+                labelIndex.erase(label);
+        }
+        code[i].labels.clear();
+    }
+
+    size_t nextLive(size_t i) const
+    {
+        while (i < code.size() && code[i].removed)
+            i++;
+        return i;
+    }
+
+    size_t lastLive(const BasicBlock &block) const
+    {
+        size_t i = block.end - 1;
+        while (i > block.begin && code[i].removed)
+            i--;
+        return i;
+    }
+
+    size_t resolve(const std::string &label) const
+    {
+        auto it = labelIndex.find(label);
+        return it == labelIndex.end() ? code.size() : it->second;
+    }
+
+    size_t liveCount() const
+    {
+        size_t count = 0;
+        for (const auto &instr : code)
+        {
+            if (!instr.removed)
+                count++;
+        }
+        return count;
+    }
+
+    // O bloco 'b' é o fall-through do anterior?
+    static bool fallsInto(const BasicBlock &previous, size_t b)
+    {
+        return std::find(previous.successors.begin(), previous.successors.end(), b) != previous.successors.end();
+    }
+
+    static bool isImmediateArith(const IrInstr &instr)
+    {
+        return (instr.mnemonic == "ADD" || instr.mnemonic == "SUB") && !instr.operand.empty() && instr.operand[0] == '#';
+    }
+
+    static int64_t signedImmediate(const IrInstr &instr)
+    {
+        int64_t k = immediate(instr.operand);
+        return instr.mnemonic == "ADD" ? k : -k;
+    }
+
+    static bool isBranch(const std::string &m) { return m == "JUMP" || m == "JEQ" || m == "CALL"; }
+
+    static bool endsBlock(const std::string &m)
+    {
+        return isBranch(m) || m == "RET" || m == "HALT";
+    }
+
+    static bool isSymbol(const std::string &operand)
+    {
+        return !operand.empty() && operand[0] != '#' && !isdigit((unsigned char)operand[0]);
+    }
+
+    static int64_t immediate(const std::string &operand)
+    {
+        try
+        {
+            // Mesmo truncamento de 23 bits do Assembler
+            return (int64_t)((uint32_t)std::stoi(operand.substr(1)) & 0x7FFFFF);
+        }
+        catch (...)
+        {
+            return 0;
+        }
+    }
+
+    static bool isVolatile(const std::string &operand)
+    {
+        if (!isdigit((unsigned char)operand[0]))
+            return false; // Labels apontam para o código (RAM)
+        try
+        {
+            return (Address)std::stoul(operand) >= VOLATILE_BASE;
+        }
+        catch (...)
+        {
+            return true;
+        }
+    }
+};
@@ -0,0 +1,306 @@
+#pragma once
+#include "TimingModel.h"
+#include "BranchPredictor.h"
+#include "Stats.h"
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Parâmetros do núcleo fora de ordem
+struct OutOfOrderConfig
+{
+    unsigned int fetchWidth = 4;    // Instruções buscadas por ciclo
+    unsigned int issueWidth = 4;    // Instruções despachadas às unidades por ciclo
+    unsigned int commitWidth = 4;   // Instruções aposentadas por ciclo
+    size_t robSize = 64;            // Reorder Buffer
+    size_t lsqSize = 16;            // Load/Store Queue
+    unsigned int frontendDepth = 3; // Fetch -> Decode -> Rename -> Dispatch
+};
+
+// Modelo de tempo superescalar fora de ordem, guiado pelo retire trace.
+// A CPU funcional continua executando em ordem; aqui só calculamos QUANDO
+// cada instrução teria sido buscada, despachada, executada e aposentada:
+//  - ACC e SP renomeados: só dependências verdadeiras (RAW) seguram a emissão;
+//  - ROB e LSQ finitos: o despacho espera uma entrada livre;
+//  - Desambiguação de memória: load só espera um store mais antigo ao MESMO
+//    endereço (e recebe o dado por forwarding); os demais passam na frente;
+//  - Interrupções precisas: a ISR só é buscada depois que todas as
+//    instruções anteriores foram aposentadas (checkInterrupts).
+class OutOfOrderModel : public ITimingModel
+{
+private:
+    OutOfOrderConfig config;
+    Stats *stats;
+    BranchUnit *branchUnit = nullptr;
+    std::string modelName;
+
+    // Estado do front-end
+    unsigned long long fetchCycle = 0;  // Ciclo do grupo de busca atual
+    unsigned int fetchedInGroup = 0;
+    unsigned long long redirectCycle = 0; // Busca bloqueada até aqui (desvio/IRQ)
+
+    // Renomeação: ciclo em que o último produtor de ACC/SP fica pronto
+    unsigned long long accReady = 0;
+    unsigned long long spReady = 0;
+
+    // Ciclos de commit das instruções em voo (para ocupação de ROB/LSQ)
+    std::deque<unsigned long long> robCommits;
+    std::deque<unsigned long long> lsqCommits;
+
+    // Stores recentes (endereço e ciclo em que o dado fica pronto)
+    struct PendingStore
+    {
+        Address addr;
+        unsigned long long dataReady;
+        unsigned long long commit;
+    };
+    std::deque<PendingStore> stores;
+
+    // Uso das portas de emissão por ciclo (janela circular)
+    static const size_t SLOT_WINDOW = 4096;
+    std::vector<unsigned long long> slotCycle;
+    std::vector<unsigned int> slotUsed;
+
+    // Commit em ordem
+    unsigned long long lastCommit = 0;
+    unsigned int committedInCycle = 0;
+    unsigned long long clock = 0; // Último ciclo já repassado a stats->totalCycles
+
+public:
+    OutOfOrderModel(Stats *s, OutOfOrderConfig cfg = OutOfOrderConfig())
+        : config(cfg), stats(s), slotCycle(SLOT_WINDOW, ~0ULL), slotUsed(SLOT_WINDOW, 0)
+    {
+        modelName = "ooo-" + std::to_string(config.issueWidth) + "w (ROB " + std::to_string(config.robSize) +
+                    ", LSQ " + std::to_string(config.lsqSize) + ")";
+    }
+
+    void setBranchUnit(BranchUnit *unit) { branchUnit = unit; }
+
+    const char *name() const override { return modelName.c_str(); }
+
+    unsigned int retire(const RetiredInstruction &instr) override
+    {
+        // --- Interrupção precisa: esvazia a janela antes de buscar a ISR ---
+        if (instr.irqEntry)
+        {
+            unsigned long long drained = lastCommit + 1;
+            unsigned long long earliest = std::max(redirectCycle, fetchCycle);
+            if (drained > earliest)
+            {
+                if (stats)
+                    stats->stallIrqFlush += drained - earliest;
+                redirectCycle = drained;
+            }
+        }
+
+        // --- FETCH ---
+        unsigned long long fetch = std::max(fetchCycle, redirectCycle);
+        if (fetch != fetchCycle || fetchedInGroup >= config.fetchWidth)
+        {
+            if (fetch == fetchCycle)
+                fetch++;
+            fetchCycle = fetch;
+            fetchedInGroup = 0;
+        }
+        fetch += instr.fetchStall;
+        if (instr.fetchStall > 0)
+        {
+            fetchCycle = fetch;
+            fetchedInGroup = 0;
+            if (stats)
+                stats->stallFetchMemory += instr.fetchStall;
+        }
+        fetchedInGroup++;
+
+        // --- DISPATCH (espera ROB / LSQ livres) ---
+        unsigned long long dispatch = fetch + config.frontendDepth;
+        retireOlderThan(dispatch);
+        bool isMem = instr.memRead || instr.memWrite;
+        if (robCommits.size() >= config.robSize)
+        {
+            unsigned long long freeAt = robCommits.front() + 1;
+            if (freeAt > dispatch)
+            {
+                if (stats)
+                    stats->oooRobFullCycles += freeAt - dispatch;
+                dispatch = freeAt;
+            }
+            retireOlderThan(dispatch);
+        }
+        if (isMem && lsqCommits.size() >= config.lsqSize)
+        {
+            unsigned long long freeAt = lsqCommits.front() + 1;
+            if (freeAt > dispatch)
+            {
+                if (stats)
+                    stats->oooLsqFullCycles += freeAt - dispatch;
+                dispatch = freeAt;
+            }
+            retireOlderThan(dispatch);
+        }
+
+        // --- Operandos prontos (registradores renomeados) ---
+        unsigned long long ready = dispatch;
+        if (RetiredInstruction::readsACC(instr.type))
+            ready = std::max(ready, accReady);
+        if (RetiredInstruction::usesSP(instr.type))
+            ready = std::max(ready, spReady);
+
+        // --- Desambiguação de memória ---
+        bool forwarded = false;
+        if (instr.memRead)
+        {
+            for (auto it = stores.rbegin(); it != stores.rend(); ++it)
+            {
+                if (it->addr == instr.memAddr)
+                {
+                    ready = std::max(ready, it->dataReady);
+                    forwarded = true;
+                    if (stats)
+                        stats->oooStoreForwards++;
+                    break;
+                }
+            }
+        }
+
+        // --- ISSUE (largura limitada por ciclo) ---
+        unsigned long long issue = claimSlot(ready);
+
+        // --- EXECUTE ---
+        unsigned int latency = instr.execLatency;
+        if (isMem)
+        {
+            // Load com forwarding não vai à Cache; os demais pagam o acesso
+            latency += forwarded ? 0 : 1 + instr.dataStall;
+            if (stats)
+                stats->stallDataMemory += forwarded ? 0 : instr.dataStall;
+        }
+        unsigned long long complete = issue + latency;
+
+        if (RetiredInstruction::writesACC(instr.type))
+            accReady = complete;
+        if (RetiredInstruction::usesSP(instr.type))
+            spReady = issue + 1; // Atualização do SP não depende do acesso à memória
+
+        // --- Desvios ---
+        redirectAfterBranch(instr, fetch, complete);
+
+        // --- COMMIT (em ordem, largura limitada) ---
+        unsigned long long commit = std::max(complete, lastCommit);
+        if (commit == lastCommit)
+        {
+            if (committedInCycle >= config.commitWidth)
+            {
+                commit++;
+                committedInCycle = 0;
+            }
+        }
+        else
+        {
+            committedInCycle = 0;
+        }
+        committedInCycle++;
+        lastCommit = commit;
+
+        robCommits.push_back(commit);
+        if (isMem)
+            lsqCommits.push_back(commit);
+        if (instr.memWrite)
+        {
+            stores.push_back({instr.memAddr, complete, commit});
+            if (stores.size() > config.lsqSize)
+                stores.pop_front();
+        }
+
+        // O relógio global acompanha o último commit
+        unsigned int advanced = 0;
+        if (commit > clock)
+        {
+            advanced = (unsigned int)(commit - clock);
+            clock = commit;
+            if (stats)
+                stats->totalCycles += advanced;
+        }
+        return advanced;
+    }
+
+private:
+    // Libera entradas de ROB/LSQ (e stores) já aposentadas até 'cycle'
+    void retireOlderThan(unsigned long long cycle)
+    {
+        while (!robCommits.empty() && robCommits.front() < cycle)
+            robCommits.pop_front();
+        while (!lsqCommits.empty() && lsqCommits.front() < cycle)
+            lsqCommits.pop_front();
+        while (!stores.empty() && stores.front().commit < cycle)
+            stores.pop_front();
+    }
+
+    unsigned long long claimSlot(unsigned long long cycle)
+    {
+        while (true)
+        {
+            size_t slot = cycle % SLOT_WINDOW;
+            if (slotCycle[slot] != cycle)
+            {
+                slotCycle[slot] = cycle;
+                slotUsed[slot] = 0;
+            }
+            if (slotUsed[slot] < config.issueWidth)
+            {
+                slotUsed[slot]++;
+                return cycle;
+            }
+            cycle++;
+        }
+    }
+
+    void redirectAfterBranch(const RetiredInstruction &instr, unsigned long long fetch, unsigned long long complete)
+    {
+        bool isBranch = instr.type == InstructionType::JEQ || instr.type == InstructionType::JUMP ||
+                        instr.type == InstructionType::CALL || instr.type == InstructionType::RET;
+
+        bool mispredicted;  // Caminho certo só conhecido na execução
+        bool decodeRedirect; // Destino direto descoberto no decode
+        if (branchUnit)
+        {
+            // Também é chamado para não-desvios (empilha retorno de IRQ no RAS)
+            unsigned int penalty = branchUnit->resolve(instr);
+            mispredicted = penalty >= 2;
+            decodeRedirect = penalty == 1;
+        }
+        else
+        {
+            // Sem preditor: não-tomado estático e sem RAS
+            bool indirectOrConditional = instr.type == InstructionType::JEQ || instr.type == InstructionType::RET;
+            mispredicted = instr.branchTaken && indirectOrConditional;
+            decodeRedirect = instr.branchTaken && !indirectOrConditional;
+        }
+        if (!isBranch)
+            return;
+
+        unsigned long long target = redirectCycle;
+        if (mispredicted)
+        {
+            target = complete + 1;
+            if (stats)
+                stats->oooMispredictFlushes++;
+        }
+        else if (decodeRedirect)
+        {
+            target = fetch + 2;
+        }
+        else if (instr.branchTaken)
+        {
+            target = fetch + 1; // Desvio tomado encerra o grupo de busca
+        }
+
+        if (target > redirectCycle)
+        {
+            if (stats && target > fetch + 1)
+                stats->stallBranchFlush += target - (fetch + 1);
+            redirectCycle = target;
+        }
+    }
+};
@@ -2,11 +2,19 @@
 #include <cstdint>
 #include "Stats.h" // Incluir
 
+// Vetores de interrupção conhecidos
+namespace IrqVector
+{
+    const uint8_t KEYBOARD = 1;   // Teclado (ISR em 500)
+    const uint8_t PAGE_FAULT = 2; // Falha de página da MMU (ISR em 700, não mascarável)
+}
+
 class PIC
 {
 private:
-    bool interruptPending = false;
-    uint8_t irqVector = 0;
+    // Um bit pendente por vetor (0..31). Vetores maiores têm prioridade.
+    uint32_t pendingMask = 0;
+    unsigned long long requestTimestamp[32] = {};
     Stats *stats; // Referência às estatísticas
 
 public:
@@ -15,19 +23,27 @@ public:
 
     void requestIRQ(uint8_t vector, unsigned long long currentCycle)
     {
-        interruptPending = true;
-        irqVector = vector;
-
-        // Registra o momento exato do pedido
-        if (stats)
-            stats->irqRequestTimestamp = currentCycle;
+        if (!(pendingMask & (1u << vector)))
+        {
+            // Registra o momento exato do pedido
+            requestTimestamp[vector] = currentCycle;
+        }
+        pendingMask |= (1u << vector);
     }
 
-    bool isPending() const { return interruptPending; }
+    bool isPending() const { return pendingMask != 0; }
+    bool isPending(uint8_t vector) const { return (pendingMask & (1u << vector)) != 0; }
 
     uint8_t ackIRQ()
     {
-        interruptPending = false;
-        return irqVector;
+        uint8_t vector = 31;
+        while (!(pendingMask & (1u << vector)) && vector > 0)
+            vector--;
+        pendingMask &= ~(1u << vector);
+
+        // A CPU calcula a latência a partir deste timestamp
+        if (stats)
+            stats->irqRequestTimestamp = requestTimestamp[vector];
+        return vector;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,157 @@
+#pragma once
+#include "TimingModel.h"
+#include "Stats.h"
+#include "BranchPredictor.h"
+
+// Modelo de tempo de pipeline clássico de 5 estágios (IF/ID/EX/MEM/WB).
+// Em regime, cada instrução custa 1 ciclo; a isto somamos as bolhas:
+//  - Hazard de ACC: com forwarding, só o "load-use" (valor vindo da memória
+//    no MEM) custa 1 ciclo; sem forwarding, o consumidor espera o WB.
+//  - Hazard de SP: PUSH/POP/CALL/RET leem e escrevem o SP no EX.
+//  - Memória: ciclos de miss da busca (IF) e do acesso a dados (MEM).
+//  - Desvios: JUMP/CALL resolvem no ID (1 bolha), JEQ tomado no EX (2),
+//    RET lê o destino da pilha no MEM (3). Não-tomado é previsto de graça.
+//  - IRQ: a entrada na ISR esvazia o pipeline (3 bolhas).
+class PipelineModel : public ITimingModel
+{
+private:
+    Stats *stats;
+    bool forwarding;
+    bool started = false;
+
+    // Produtores recentes (distância 1 e 2) de ACC e SP
+    struct Producer
+    {
+        bool writesACC = false;
+        bool accFromMemory = false; // Valor só existe após o MEM
+        bool writesSP = false;
+    };
+    Producer previous[2]; // [0] = instrução anterior, [1] = a de antes dela
+
+    BranchUnit *branchUnit = nullptr; // Preditor de desvios (opcional)
+
+public:
+    PipelineModel(Stats *s, bool useForwarding = true) : stats(s), forwarding(useForwarding) {}
+
+    // Com preditor, só desvios mal previstos pagam bolhas
+    void setBranchUnit(BranchUnit *unit) { branchUnit = unit; }
+
+    const char *name() const override { return forwarding ? "pipeline-5 (forwarding)" : "pipeline-5 (sem forwarding)"; }
+
+    unsigned int retire(const RetiredInstruction &instr) override
+    {
+        unsigned int cycles = 1;
+
+        // Enchimento do pipeline: a primeira instrução atravessa os 5 estágios
+        if (!started)
+        {
+            started = true;
+            cycles += 4;
+            if (stats)
+                stats->pipelineFillCycles += 4;
+        }
+
+        // --- Interrupção: descarta o que estava no pipeline ---
+        if (instr.irqEntry)
+        {
+            cycles += 3;
+            if (stats)
+                stats->stallIrqFlush += 3;
+            previous[0] = Producer();
+            previous[1] = Producer();
+        }
+
+        // --- Hazards de Dados ---
+        unsigned int dataStall = RetiredInstruction::readsACC(instr.type) ? hazardStall(true) : 0;
+        unsigned int stackStall = RetiredInstruction::usesSP(instr.type) ? hazardStall(false) : 0;
+
+        cycles += dataStall + stackStall;
+        if (stats)
+        {
+            stats->stallDataHazard += dataStall;
+            stats->stallStackHazard += stackStall;
+        }
+
+        // --- Operações em bloco ocupam o EX por vários ciclos ---
+        unsigned int multiCycle = instr.execLatency - 1;
+        cycles += multiCycle;
+        if (stats)
+            stats->stallMultiCycle += multiCycle;
+
+        // --- Memória ---
+        cycles += instr.fetchStall + instr.dataStall;
+        if (stats)
+        {
+            stats->stallFetchMemory += instr.fetchStall;
+            stats->stallDataMemory += instr.dataStall;
+        }
+
+        // --- Controle de Fluxo ---
+        unsigned int flush = branchPenalty(instr);
+        cycles += flush;
+        if (stats)
+            stats->stallBranchFlush += flush;
+
+        // Desloca a janela de produtores
+        previous[1] = previous[0];
+        previous[0] = producerOf(instr);
+
+        if (stats)
+            stats->totalCycles += cycles;
+        return cycles;
+    }
+
+protected:
+    // Custo de um desvio. Sem preditor: não-tomado estático, destino no ID/EX/MEM.
+    virtual unsigned int branchPenalty(const RetiredInstruction &instr)
+    {
+        if (branchUnit)
+            return branchUnit->resolve(instr);
+
+        switch (instr.type)
+        {
+        case InstructionType::JUMP:
+        case InstructionType::CALL:
+            return 1;
+        case InstructionType::JEQ:
+            return instr.branchTaken ? 2 : 0;
+        case InstructionType::RET:
+            return 3;
+        default:
+            return 0;
+        }
+    }
+
+private:
+    // Bolhas para um consumidor de ACC (acc=true) ou de SP (acc=false)
+    unsigned int hazardStall(bool acc) const
+    {
+        for (int distance = 0; distance < 2; distance++)
+        {
+            const Producer &p = previous[distance];
+            bool writes = acc ? p.writesACC : p.writesSP;
+            if (!writes)
+                continue;
+
+            if (forwarding)
+            {
+                // Só o load-use da instrução imediatamente anterior custa
+                return (acc && distance == 0 && p.accFromMemory) ? 1 : 0;
+            }
+            // Sem forwarding: espera o WB (2 bolhas a distância 1, 1 a distância 2)
+            return (unsigned int)(2 - distance);
+        }
+        return 0;
+    }
+
+    static Producer producerOf(const RetiredInstruction &instr)
+    {
+        Producer p;
+        p.writesACC = RetiredInstruction::writesACC(instr.type);
+        // Operando só chega no MEM: LOAD/ALU em modo endereço, POP e MEMCMP
+        p.accFromMemory = p.writesACC && (instr.isAddressMode || instr.type == InstructionType::POP ||
+                                          instr.type == InstructionType::MEMCMP);
+        p.writesSP = RetiredInstruction::usesSP(instr.type);
+        return p;
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+#include "Types.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Interface de Prefetcher (plugável na Cache).
+// Trabalha com endereços de BLOCO (addr / blockSize).
+class Prefetcher
+{
+public:
+    virtual ~Prefetcher() = default;
+
+    virtual std::string name() const = 0;
+
+    // Observa um acesso de demanda e sugere blocos para buscar antecipadamente.
+    // 'pc' é o endereço da instrução que gerou o acesso.
+    // 'miss' também vale true no primeiro uso de um bloco pré-buscado (tagged prefetch).
+    virtual void observe(Address addr, uint32_t blockAddr, Address pc, bool miss,
+                         std::vector<uint32_t> &candidates) = 0;
+
+    // Prefetchers com buffer próprio (Stream Buffer) guardam os dados fora da
+    // Cache para não poluí-la. Os demais devolvem false e a Cache recebe o bloco.
+    virtual bool ownsBuffer() const { return false; }
+    virtual void store(uint32_t, const Word *, size_t) {}
+
+    // Consulta o buffer num miss da Cache: se o bloco estiver lá, copia e remove
+    virtual bool take(uint32_t, Word *, size_t) { return false; }
+
+    // Um STORE tornou a cópia do bloco no buffer obsoleta
+    virtual void invalidate(uint32_t) {}
+};
+
+// --- Next-N-Line ---
+// Num miss (ou no primeiro uso de um bloco pré-buscado) pede os N blocos seguintes.
+class NextLinePrefetcher : public Prefetcher
+{
+private:
+    size_t degree;
+
+public:
+    NextLinePrefetcher(size_t n = 1) : degree(n) {}
+
+    std::string name() const override { return "next-" + std::to_string(degree) + "-line"; }
+
+    void observe(Address, uint32_t blockAddr, Address, bool miss,
+                 std::vector<uint32_t> &candidates) override
+    {
+        if (!miss)
+            return;
+        for (size_t i = 1; i <= degree; i++)
+        {
+            candidates.push_back(blockAddr + (uint32_t)i);
+        }
+    }
+};
+
+// --- Tabela de Stride indexada por PC ---
+// Cada instrução de LOAD/STORE aprende o passo entre seus acessos.
+// Com confiança suficiente, busca addr + stride (em palavras).
+class StridePrefetcher : public Prefetcher
+{
+private:
+    struct Entry
+    {
+        bool valid = false;
+        Address pc = 0;
+        Address lastAddr = 0;
+        int32_t stride = 0;
+        int confidence = 0; // Saturante 0..3
+    };
+
+    std::vector<Entry> table;
+    size_t blockSize;
+    size_t degree;
+
+public:
+    StridePrefetcher(size_t entries = 16, size_t wordsPerBlock = 4, size_t n = 1)
+        : blockSize(wordsPerBlock), degree(n)
+    {
+        table.resize(entries);
+    }
+
+    std::string name() const override { return "stride"; }
+
+    void observe(Address addr, uint32_t blockAddr, Address pc, bool,
+                 std::vector<uint32_t> &candidates) override
+    {
+        // Busca de instrução (addr == pc) não passa pela tabela de dados
+        if (addr == pc)
+            return;
+
+        Entry &e = table[pc % table.size()];
+        if (!e.valid || e.pc != pc)
+        {
+            e.valid = true;
+            e.pc = pc;
+            e.lastAddr = addr;
+            e.stride = 0;
+            e.confidence = 0;
+            return;
+        }
+
+        int32_t stride = (int32_t)addr - (int32_t)e.lastAddr;
+        if (stride != 0 && stride == e.stride)
+        {
+            e.confidence = std::min(e.confidence + 1, 3);
+        }
+        else
+        {
+            e.confidence = std::max(e.confidence - 1, 0);
+            e.stride = stride;
+        }
+        e.lastAddr = addr;
+
+        if (e.confidence >= 2)
+        {
+            for (size_t i = 1; i <= degree; i++)
+            {
+                int64_t target = (int64_t)addr + (int64_t)e.stride * (int64_t)i;
+                if (target < 0)
+                    break;
+                uint32_t targetBlock = (uint32_t)(target / (int64_t)blockSize);
+                if (targetBlock != blockAddr)
+                    candidates.push_back(targetBlock);
+            }
+        }
+    }
+};
+
+// --- Stream Buffer (Jouppi) ---
+// FIFO de blocos sequenciais guardados FORA da Cache.
+// Num miss que não acerta a cabeça do buffer, o stream é realocado.
+class StreamBuffer : public Prefetcher
+{
+private:
+    struct Slot
+    {
+        uint32_t blockAddr;
+        std::vector<Word> data;
+    };
+
+    size_t depth;
+    std::deque<Slot> slots;
+    uint32_t streamStart = 0; // Primeiro bloco do stream atual
+    uint32_t nextBlock = 0;   // Próximo bloco que o stream vai pedir
+    size_t outstanding = 0;   // Pedidos na fila de prefetch ainda não entregues
+    bool lastTakeHit = false; // O último miss foi atendido pela cabeça do stream?
+
+public:
+    StreamBuffer(size_t entries = 4) : depth(entries) {}
+
+    std::string name() const override { return "stream-buffer"; }
+
+    bool ownsBuffer() const override { return true; }
+
+    void observe(Address, uint32_t blockAddr, Address, bool miss,
+                 std::vector<uint32_t> &candidates) override
+    {
+        if (!miss)
+            return;
+
+        // Miss fora do stream atual: começa um novo stream a partir do próximo bloco
+        if (!lastTakeHit)
+        {
+            slots.clear();
+            streamStart = blockAddr + 1;
+            nextBlock = streamStart;
+            outstanding = 0;
+        }
+        lastTakeHit = false;
+
+        // Mantém o buffer cheio (contando o que ainda está a caminho)
+        while (slots.size() + outstanding < depth)
+        {
+            candidates.push_back(nextBlock++);
+            outstanding++;
+        }
+    }
+
+    void store(uint32_t blockAddr, const Word *data, size_t blockSize) override
+    {
+        // Entrega atrasada de um stream que já foi abandonado
+        if (blockAddr < streamStart || blockAddr >= nextBlock)
+            return;
+        if (outstanding > 0)
+            outstanding--;
+        if (slots.size() >= depth)
+            slots.pop_front();
+        Slot slot;
+        slot.blockAddr = blockAddr;
+        slot.data.assign(data, data + blockSize);
+        slots.push_back(slot);
+    }
+
+    void invalidate(uint32_t blockAddr) override
+    {
+        for (auto it = slots.begin(); it != slots.end(); ++it)
+        {
+            if (it->blockAddr == blockAddr)
+            {
+                slots.erase(it);
+                return;
+            }
+        }
+    }
+
+    bool take(uint32_t blockAddr, Word *data, size_t blockSize) override
+    {
+        // Só a cabeça da FIFO é comparada (como no hardware original)
+        if (slots.empty() || slots.front().blockAddr != blockAddr)
+            return false;
+        std::memcpy(data, slots.front().data.data(), blockSize * sizeof(Word));
+        slots.pop_front();
+        lastTakeHit = true;
+        return true;
+    }
+};
@@ -0,0 +1,255 @@
+#pragma once
+#include "MappedFile.h"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Pré-processador do montador: INCLUDE, MACRO/ENDM e EQU.
+// Trabalha em texto e entrega um fonte "plano" para o Assembler.
+//
+//   INCLUDE "drivers/teclado.txt"   ; caminho relativo ao arquivo atual
+//   TECLADO EQU 61440               ; constante (vale em operandos e após '#')
+//   MACRO IMPRIME valor             ; parâmetros separados por vírgula
+//       LOAD valor
+//       STORE 57344
+//   ENDM
+//   IMPRIME #65
+//
+// Dentro de uma macro, "\@" vira um número único por expansão, para labels
+// locais (ex.: "LOOP\@:").
+class Preprocessor
+{
+private:
+    struct Macro
+    {
+        std::vector<std::string> params;
+        std::vector<std::string> body;
+    };
+
+    static const int MAX_DEPTH = 16; // INCLUDE/macro aninhados (evita recursão infinita)
+
+    std::unordered_map<std::string, std::string> constants;
+    std::unordered_map<std::string, Macro> macros;
+    std::string output;
+    size_t expansions = 0;
+    bool failed = false;
+
+    // Macro sendo definida
+    Macro *recording = nullptr;
+
+public:
+    // Só vale a pena pré-processar se alguma diretiva aparece no fonte
+    static bool needed(std::string_view source)
+    {
+        return source.find("INCLUDE") != std::string_view::npos ||
+               source.find("MACRO") != std::string_view::npos ||
+               source.find("EQU") != std::string_view::npos;
+    }
+
+    bool processFile(const std::string &path)
+    {
+        output.clear();
+        failed = false;
+        includeFile(path, 0);
+        if (recording)
+        {
+            error("MACRO sem ENDM");
+            recording = nullptr;
+        }
+        return !failed;
+    }
+
+    const std::string &result() const { return output; }
+
+private:
+    void includeFile(const std::string &path, int depth)
+    {
+        if (depth > MAX_DEPTH)
+        {
+            error("INCLUDE aninhado demais: " + path);
+            return;
+        }
+        MappedFile file;
+        if (!file.open(path))
+        {
+            error("Arquivo nao encontrado: " + path);
+            return;
+        }
+        size_t slash = path.find_last_of('/');
+        std::string dir = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+
+        std::string_view source = file.view();
+        size_t pos = 0;
+        while (pos < source.size())
+        {
+            size_t eol = source.find('\n', pos);
+            if (eol == std::string_view::npos)
+                eol = source.size();
+            processLine(source.substr(pos, eol - pos), dir, depth);
+            pos = eol + 1;
+        }
+    }
+
+    void processLine(std::string_view raw, const std::string &dir, int depth)
+    {
+        size_t comment = raw.find(';');
+        std::string_view line = trim(comment == std::string_view::npos ? raw : raw.substr(0, comment));
+        if (line.empty())
+            return;
+
+        std::vector<std::string_view> words = split(line, " \t");
+
+        // Gravando o corpo de uma macro
+        if (recording)
+        {
+            if (words[0] == "ENDM")
+                recording = nullptr;
+            else
+                recording->body.emplace_back(line);
+            return;
+        }
+
+        if (words[0] == "INCLUDE" && words.size() >= 2)
+        {
+            std::string_view name = trim(line.substr(7));
+            if (name.size() >= 2 && name.front() == '"' && name.back() == '"')
+                name = name.substr(1, name.size() - 2);
+            std::string path(name);
+            includeFile(path[0] == '/' ? path : dir + path, depth + 1);
+            return;
+        }
+
+        if (words[0] == "MACRO" && words.size() >= 2)
+        {
+            Macro &macro = macros[std::string(words[1])];
+            macro = Macro();
+            size_t after = line.find(words[1]) + words[1].size();
+            for (std::string_view param : split(line.substr(after), ", \t"))
+                macro.params.emplace_back(param);
+            recording = &macro;
+            return;
+        }
+
+        if (words.size() >= 3 && words[1] == "EQU")
+        {
+            constants[std::string(words[0])] = substitute(std::string(words[2]), nullptr, nullptr);
+            return;
+        }
+
+        auto macro = macros.find(std::string(words[0]));
+        if (macro != macros.end())
+        {
+            expand(macro->second, line.substr(words[0].size()), dir, depth);
+            return;
+        }
+
+        output += substitute(std::string(line), nullptr, nullptr);
+        output += '\n';
+    }
+
+    void expand(const Macro &macro, std::string_view argText, const std::string &dir, int depth)
+    {
+        if (depth > MAX_DEPTH)
+        {
+            error("Macro recursiva demais");
+            return;
+        }
+        std::vector<std::string> args;
+        for (std::string_view arg : split(argText, ","))
+            args.emplace_back(trim(arg));
+        if (args.size() != macro.params.size())
+        {
+            error("Macro chamada com " + std::to_string(args.size()) + " argumentos, esperava " +
+                  std::to_string(macro.params.size()));
+            return;
+        }
+
+        std::string unique = std::to_string(expansions++);
+        for (const std::string &bodyLine : macro.body)
+        {
+            std::string line = substitute(bodyLine, &macro.params, &args);
+            size_t at;
+            while ((at = line.find("\\@")) != std::string::npos)
+                line.replace(at, 2, "_" + unique);
+            processLine(line, dir, depth + 1);
+        }
+    }
+
+    // Troca tokens inteiros (também após '#' e antes de ':') por parâmetros e constantes
+    std::string substitute(const std::string &line, const std::vector<std::string> *params,
+                           const std::vector<std::string> *args) const
+    {
+        std::string out;
+        size_t i = 0;
+        while (i < line.size())
+        {
+            if (!isTokenChar(line[i]))
+            {
+                out += line[i++];
+                continue;
+            }
+            size_t start = i;
+            while (i < line.size() && isTokenChar(line[i]))
+                i++;
+            std::string token = line.substr(start, i - start);
+
+            bool replaced = false;
+            if (params)
+            {
+                for (size_t p = 0; p < params->size(); p++)
+                {
+                    if ((*params)[p] == token)
+                    {
+                        out += (*args)[p];
+                        replaced = true;
+                        break;
+                    }
+                }
+            }
+            if (!replaced)
+            {
+                auto constant = constants.find(token);
+                out += (constant != constants.end()) ? constant->second : token;
+            }
+        }
+        return out;
+    }
+
+    void error(const std::string &message)
+    {
+        std::cerr << "[Preprocessor Error] " << message << std::endl;
+        failed = true;
+    }
+
+    static bool isTokenChar(char c) { return isalnum((unsigned char)c) || c == '_' || c == '.'; }
+
+    static std::string_view trim(std::string_view text)
+    {
+        const char *whitespace = " \t\r\n";
+        size_t start = text.find_first_not_of(whitespace);
+        if (start == std::string_view::npos)
+            return std::string_view();
+        size_t end = text.find_last_not_of(whitespace);
+        return text.substr(start, end - start + 1);
+    }
+
+    static std::vector<std::string_view> split(std::string_view text, const char *separators)
+    {
+        std::vector<std::string_view> parts;
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            size_t start = text.find_first_not_of(separators, pos);
+            if (start == std::string_view::npos)
+                break;
+            size_t end = text.find_first_of(separators, start);
+            if (end == std::string_view::npos)
+                end = text.size();
+            parts.push_back(text.substr(start, end - start));
+            pos = end;
+        }
+        return parts;
+    }
+};
@@ -1,7 +1,9 @@
 #pragma once
 #include <vector>
 #include <iostream>
+#include <cstring>
 #include "IMemoryDevice.h"
+#include "Dram.h"
 
 class Ram : public IMemoryDevice
 {
@@ -10,11 +12,16 @@ private:
     // O requisito dizia 1024 posições.
     std::vector<Word> dados;
     const size_t SIZE = 1024;
+    mutable DramController dram; // Modelo de tempo (bancos + row buffers); muda até numa leitura
+
+    // Páginas escritas desde o último clearDirty() (checkpoints incrementais)
+    std::vector<uint8_t> dirty;
 
 public:
-    Ram()
+    Ram(Stats *s = nullptr, DramConfig dramConfig = DramConfig()) : dram(dramConfig, s)
     {
         dados.resize(SIZE, 0); // Inicializa tudo com 0
+        dirty.resize(SIZE / PAGE_WORDS, 0);
     }
 
     Word read(Address addr) const override
@@ -35,14 +42,82 @@ public:
             return;
         }
         dados[addr] = value;
+        dirty[addr / PAGE_WORDS] = 1;
+    }
+
+    // Burst: uma checagem de limites e um memcpy para o bloco inteiro
+    unsigned int readBlock(Address addr, Word *dst, size_t count) const override
+    {
+        size_t valid = clampCount(addr, count, "Leitura");
+        if (valid > 0)
+            std::memcpy(dst, dados.data() + addr, valid * sizeof(Word));
+        if (valid < count)
+            std::memset(dst + valid, 0, (count - valid) * sizeof(Word));
+        return dram.access(addr, count, false);
+    }
+
+    unsigned int writeBlock(Address addr, const Word *src, size_t count) override
+    {
+        size_t valid = clampCount(addr, count, "Escrita");
+        if (valid > 0)
+        {
+            std::memcpy(dados.data() + addr, src, valid * sizeof(Word));
+            markDirty(addr, valid);
+        }
+        return dram.access(addr, count, true);
     }
 
-    // Método extra apenas para debug (não faz parte da interface IMemoryDevice)
-    void loadProgram(const std::vector<Word> &program)
+    DramController &getDram() { return dram; }
+    const DramController &getDram() const { return dram; }
+
+    size_t size() const { return SIZE; }
+
+    // Carga do firmware: copia um segmento da imagem mapeada direto para a RAM.
+    // Segmento que não cabe é erro (antes o excesso era descartado em silêncio).
+    bool loadSegment(Address addr, const Word *words, size_t count)
     {
-        for (size_t i = 0; i < program.size() && i < SIZE; ++i)
+        if (addr > SIZE || count > SIZE - addr)
+        {
+            std::cerr << "[Erro de Carga] Segmento " << addr << ".." << addr + count - 1
+                      << " nao cabe na RAM (" << SIZE << " palavras)" << std::endl;
+            return false;
+        }
+        std::memcpy(dados.data() + addr, words, count * sizeof(Word));
+        markDirty(addr, count);
+        return true;
+    }
+
+    // --- Páginas sujas ---
+    static constexpr size_t PAGE_WORDS = 64;
+
+    size_t pageCount() const { return dirty.size(); }
+    bool isDirty(size_t page) const { return dirty[page] != 0; }
+    void clearDirty() { std::fill(dirty.begin(), dirty.end(), 0); }
+    const Word *pageData(size_t page) const { return dados.data() + page * PAGE_WORDS; }
+    Word *pageData(size_t page) { return dados.data() + page * PAGE_WORDS; }
+
+private:
+    void markDirty(Address addr, size_t count)
+    {
+        if (count == 0)
+            return;
+        for (size_t page = addr / PAGE_WORDS; page <= (addr + count - 1) / PAGE_WORDS; page++)
+            dirty[page] = 1;
+    }
+
+    // Quantas palavras do burst caem dentro da RAM (o resto é erro de barramento)
+    size_t clampCount(Address addr, size_t count, const char *operation) const
+    {
+        if (addr >= SIZE)
+        {
+            std::cerr << "[Erro de Barramento] " << operation << " em bloco fora dos limites: " << addr << std::endl;
+            return 0;
+        }
+        if (addr + count > SIZE)
         {
-            dados[i] = program[i];
+            std::cerr << "[Erro de Barramento] " << operation << " em bloco cruza o fim da RAM: " << addr << std::endl;
+            return SIZE - addr;
         }
+        return count;
     }
 };
\ No newline at end of file
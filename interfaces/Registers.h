@@ -2,6 +2,7 @@
 #include "Types.h"
 #include <iostream>
 #include <iomanip> // Para formatar o debug
+#include <vector>
 
 class Registers
 {
@@ -20,6 +21,15 @@ private:
     // registrador stack pointer
     Address sp;
 
+    // Ponteiros das operações em bloco (MEMCPY/MEMSET/MEMCMP)
+    Address src;
+    Address dst;
+
+    // Modo privilegiado (kernel): sem tradução da MMU e acesso aos registradores de controle
+    bool privileged;
+    std::vector<bool> savedModes; // Modo de antes de cada ISR aninhada (restaurado no RET dela)
+    bool userOnReturn;            // Fora de ISR: o kernel pediu (via MMU) que o próximo RET entre em usuário
+
 public:
     Registers()
     {
@@ -37,6 +47,51 @@ public:
 
         // começa no fim da RAM
         sp = 1023;
+
+        src = 0;
+        dst = 0;
+
+        // Power on em modo kernel
+        privileged = true;
+        savedModes.clear();
+        userOnReturn = false;
+    }
+
+    // --- Modo de Execução ---
+    bool isPrivileged() const { return privileged; }
+    void setPrivileged(bool value) { privileged = value; }
+
+    // Entrada numa ISR: guarda o modo atual e sobe para kernel
+    void enterKernel()
+    {
+        savedModes.push_back(privileged);
+        privileged = true;
+    }
+
+    // RET que fecha a ISR: volta ao modo de antes dela
+    void returnFromIsr()
+    {
+        if (savedModes.empty())
+            return;
+        privileged = savedModes.back();
+        savedModes.pop_back();
+    }
+
+    // RET comum: só troca de modo se o kernel, fora de ISR, pediu para entrar em usuário
+    void returnFromCall()
+    {
+        if (privileged && userOnReturn && savedModes.empty())
+            privileged = false;
+        userOnReturn = false;
+    }
+
+    // Registrador da MMU: dentro de uma ISR, ela volta para usuário; fora, o próximo RET
+    void requestUserReturn()
+    {
+        if (!savedModes.empty())
+            savedModes.back() = false;
+        else
+            userOnReturn = true;
     }
 
     // --- Métodos do SP ---
@@ -49,6 +104,12 @@ public:
     // POP: Incrementa o ponteiro (encolhe para cima)
     void incSP() { sp++; }
 
+    // --- Ponteiros de Bloco ---
+    Address getSRC() const { return src; }
+    void setSRC(Address val) { src = val; }
+    Address getDST() const { return dst; }
+    void setDST(Address val) { dst = val; }
+
     // --- Manipulação do PC ---
     Address getPC() const { return pc; }
 
@@ -90,7 +151,9 @@ public:
         std::cout << "IR:  0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << ir << std::endl;
         std::cout << "ACC: " << std::dec << acc << " (0x" << std::hex << acc << ")" << std::endl;
         std::cout << "SP:  " << std::dec << sp << std::endl;
+        std::cout << "SRC: " << std::dec << src << "  DST: " << dst << std::endl;
         std::cout << "Flags: [Z: " << (zeroFlag ? "1" : "0") << "] [N: " << (negativeFlag ? "1" : "0") << "]" << std::endl;
+        std::cout << "Modo: " << (privileged ? "Kernel" : "Usuario") << std::endl;
         std::cout << "-----------------" << std::endl;
     }
 
@@ -1,7 +1,22 @@
 #pragma once
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
 #include "Colors.h"
+#include "Types.h"
+#include "Histogram.h"
+
+// Contadores de um desvio específico (por PC)
+struct BranchSiteStats
+{
+    unsigned long long executed = 0;
+    unsigned long long taken = 0;
+    unsigned long long mispredicted = 0;
+};
 
 struct Stats
 {
@@ -11,20 +26,98 @@ struct Stats
     // --- CPU ---
     unsigned long long totalInstructions = 0;
 
+    // --- Modelo de Tempo (Pipeline) ---
+    std::string timingModel;                    // Vazio = 1 instrução por ciclo
+    unsigned long long pipelineFillCycles = 0;  // Enchimento inicial do pipeline
+    unsigned long long stallDataHazard = 0;     // Dependência de ACC (load-use / sem forwarding)
+    unsigned long long stallStackHazard = 0;    // Dependência de SP (PUSH/POP/CALL/RET)
+    unsigned long long stallFetchMemory = 0;    // Miss na busca de instrução (IF)
+    unsigned long long stallDataMemory = 0;     // Miss/stall no acesso a dados (MEM)
+    unsigned long long stallBranchFlush = 0;    // Bolhas de desvio
+    unsigned long long stallIrqFlush = 0;       // Esvaziamento na entrada da ISR
+    unsigned long long stallMultiCycle = 0;     // EX ocupado por operações em bloco
+
+    // --- Fora de Ordem ---
+    unsigned long long oooRobFullCycles = 0;     // Despacho parado com ROB cheio
+    unsigned long long oooLsqFullCycles = 0;     // Despacho parado com LSQ cheia
+    unsigned long long oooStoreForwards = 0;     // Loads atendidos por store mais antigo
+    unsigned long long oooMispredictFlushes = 0; // Redirecionamentos na execução
+
+    // --- Predição de Desvios ---
+    std::string branchPredictor;               // Vazio = sem preditor
+    unsigned long long branchCount = 0;        // JEQ/JUMP/CALL/RET executados
+    unsigned long long branchMispredicts = 0;
+    unsigned long long branchPenaltyCycles = 0;
+    std::map<Address, BranchSiteStats> branchSites;
+
     // --- Memória / Cache ---
     unsigned long long cacheHits = 0;
     unsigned long long cacheMisses = 0;
     unsigned long long busWaitCycles = 0; // Ciclos perdidos esperando RAM
+    unsigned long long missPenaltyCycles = 0; // Latência medida dos preenchimentos de linha
+
+    // --- Prefetch ---
+    unsigned long long prefetchIssued = 0;    // Blocos buscados antecipadamente
+    unsigned long long prefetchUseful = 0;    // Usados pela demanda antes de sair
+    unsigned long long prefetchLate = 0;      // Demanda chegou com o bloco ainda na fila
+    unsigned long long prefetchPolluting = 0; // Expulsaram um bloco que a demanda quis de volta
+    unsigned long long prefetchDropped = 0;   // Fila cheia
+    unsigned long long prefetchBufferHits = 0; // Misses da Cache atendidos pelo Stream Buffer
+    unsigned long long prefetchBusCycles = 0; // Banda de DRAM consumida por prefetch
+
+    // --- Victim Cache ---
+    unsigned long long victimHits = 0;      // Misses da Cache salvos pela Victim Cache
+    unsigned long long victimMisses = 0;
+    unsigned long long victimSwaps = 0;     // Hit com troca de linhas (a expulsa entrou no lugar)
+    unsigned long long victimInserts = 0;
+    unsigned long long victimEvictions = 0; // Vítimas descartadas de vez (LRU)
+
+    // --- Buffer de Escrita ---
+    unsigned long long writeBufferStores = 0;
+    unsigned long long writeBufferCoalesced = 0;  // STOREs juntados a uma entrada existente
+    unsigned long long writeBufferForwards = 0;   // Preenchimentos de linha corrigidos pelo buffer
+    unsigned long long writeBufferFullEvents = 0;
+    unsigned long long writeBufferStallCycles = 0;
+    unsigned long long writeBufferDrainCycles = 0; // Barramento ocupado drenando
+    std::vector<unsigned long long> writeBufferOccupancy; // Histograma: ocupação vista por cada STORE
+
+    // --- MMU / TLB ---
+    std::string mmuConfig;                // Vazio = sem MMU
+    unsigned long long tlbHits = 0;
+    unsigned long long tlbMisses = 0;
+    unsigned long long pageWalks = 0;
+    unsigned long long pageWalkCycles = 0; // Leitura das PTEs (incluídos em busWaitCycles)
+    unsigned long long pageFaults = 0;
+
+    // --- DRAM (Row Buffer) ---
+    unsigned long long dramAccesses = 0;
+    unsigned long long dramRowHits = 0;      // Linha já aberta
+    unsigned long long dramRowMisses = 0;    // Banco fechado
+    unsigned long long dramRowConflicts = 0; // Outra linha aberta (precharge)
+    unsigned long long dramTurnarounds = 0;  // Leituras logo após uma escrita (tWTR)
+    unsigned long long dramLatencyCycles = 0;
 
     // --- IRQ ---
     unsigned long long irqRequestTimestamp = 0; // Ciclo que o IRQ chegou
     unsigned long long totalIrqLatency = 0;     // Soma das latências
     unsigned long long irqCount = 0;            // Quantas IRQs atendidas
 
+    // --- Distribuições de Latência (percentis) ---
+    LatencyHistogram irqLatencyHist;    // Pedido -> entrada na ISR
+    LatencyHistogram isrDurationHist;   // Entrada na ISR -> RET
+    LatencyHistogram memoryLatencyHist; // Cada leitura pela Cache (1 no hit, 1 + burst no miss)
+
     // --- DMA (Placeholder para futuro) ---
     unsigned long long dmaBytesCopied = 0;
     unsigned long long cpuBytesCopied = 0; // Via LOAD/STORE
 
+    // --- Operações em Bloco (MEMCPY/MEMSET/MEMCMP) ---
+    unsigned long long blockInstructions = 0;
+    unsigned long long blockBytesCopied = 0;   // MEMCPY + MEMSET
+    unsigned long long blockBytesCompared = 0; // MEMCMP
+    unsigned long long blockCycles = 0;        // Ciclos de EX + burst de memória
+    unsigned long long simdInstructions = 0;   // PADDB/PXORB
+
     // --- Métodos de Cálculo ---
 
     double getIPC()
@@ -32,6 +125,11 @@ struct Stats
         return (totalCycles == 0) ? 0.0 : (double)totalInstructions / totalCycles;
     }
 
+    double getBranchMPKI()
+    {
+        return (totalInstructions == 0) ? 0.0 : ((double)branchMispredicts / totalInstructions) * 1000.0;
+    }
+
     double getHitRate()
     {
         unsigned long long totalAccess = cacheHits + cacheMisses;
@@ -52,11 +150,120 @@ struct Stats
 
     double getAMAT()
     {
+        // Medido quando há amostras; senão, a fórmula
+        if (memoryLatencyHist.count() > 0)
+            return memoryLatencyHist.mean();
+
         // Average Memory Access Time = Hit Time + (Miss Rate * Miss Penalty)
-        // Assumindo: Hit = 1 ciclo, Miss Penalty = 10 ciclos (busca na RAM)
+        // Hit = 1 ciclo; a penalidade é a média MEDIDA dos preenchimentos (DRAM)
         const double HIT_TIME = 1.0;
-        const double MISS_PENALTY = 10.0;
-        return HIT_TIME + (getMissRate() * MISS_PENALTY);
+        unsigned long long totalAccess = cacheHits + cacheMisses;
+        return (totalAccess == 0) ? 0.0 : HIT_TIME + (double)missPenaltyCycles / totalAccess;
+    }
+
+    double getPrefetchAccuracy()
+    {
+        return (prefetchIssued == 0) ? 0.0 : (double)prefetchUseful / prefetchIssued * 100.0;
+    }
+
+    double getPrefetchCoverage()
+    {
+        // Fração dos misses originais eliminada pelo prefetch.
+        // Hits do Stream Buffer já estão contados em cacheMisses.
+        unsigned long long original = prefetchUseful + cacheMisses - prefetchBufferHits;
+        return (original == 0) ? 0.0 : (double)prefetchUseful / original * 100.0;
+    }
+
+    double getCoalescingRate()
+    {
+        return (writeBufferStores == 0) ? 0.0 : (double)writeBufferCoalesced / writeBufferStores * 100.0;
+    }
+
+    double getTlbHitRate()
+    {
+        unsigned long long total = tlbHits + tlbMisses;
+        return (total == 0) ? 0.0 : (double)tlbHits / total * 100.0;
+    }
+
+    double getRowHitRate()
+    {
+        return (dramAccesses == 0) ? 0.0 : (double)dramRowHits / dramAccesses * 100.0;
+    }
+
+    // Exporta os histogramas (um por linha) para juntar execuções depois
+    bool saveHistograms(const std::string &path) const
+    {
+        FILE *out = std::fopen(path.c_str(), "w");
+        if (!out)
+            return false;
+        std::fprintf(out, "SIMHIST 1 %u\n", LatencyHistogram::SUB_BITS);
+        irqLatencyHist.write(out, "irq_latency");
+        isrDurationHist.write(out, "isr_duration");
+        memoryLatencyHist.write(out, "memory_latency");
+        bool ok = !std::ferror(out);
+        std::fclose(out);
+        return ok;
+    }
+
+    // Soma um arquivo exportado aos histogramas atuais
+    bool mergeHistograms(const std::string &path)
+    {
+        FILE *in = std::fopen(path.c_str(), "r");
+        if (!in)
+            return false;
+        unsigned int version = 0, subBits = 0;
+        bool ok = std::fscanf(in, "SIMHIST %u %u\n", &version, &subBits) == 2 && version == 1 &&
+                  subBits == LatencyHistogram::SUB_BITS;
+        std::string line;
+        int c;
+        while (ok && (c = std::fgetc(in)) != EOF)
+        {
+            if (c != '\n')
+            {
+                line += (char)c;
+                continue;
+            }
+            size_t space = line.find(' ');
+            std::string name = line.substr(0, space);
+            LatencyHistogram hist;
+            if (space == std::string::npos || !hist.parse(line.substr(space + 1)))
+                ok = false;
+            else if (name == "irq_latency")
+                irqLatencyHist.merge(hist);
+            else if (name == "isr_duration")
+                isrDurationHist.merge(hist);
+            else if (name == "memory_latency")
+                memoryLatencyHist.merge(hist);
+            line.clear();
+        }
+        std::fclose(in);
+        return ok;
+    }
+
+    void printPercentiles(const char *label, const LatencyHistogram &hist)
+    {
+        if (hist.count() == 0)
+            return;
+        std::cout << label << std::setw(7) << hist.percentile(50) << std::setw(7) << hist.percentile(90)
+                  << std::setw(7) << hist.percentile(99) << std::setw(8) << hist.percentile(99.9)
+                  << std::setw(8) << hist.max() << "   (n=" << hist.count() << ")" << std::endl;
+    }
+
+    void printLatencyReport()
+    {
+        std::cout << "\n"
+                  << Color::CYAN << "--- Latências (ciclos) ---" << Color::RESET << std::endl;
+        std::cout << "                        p50    p90    p99   p99.9     max" << std::endl;
+        printPercentiles("Pedido IRQ -> ISR: ", irqLatencyHist);
+        printPercentiles("Duração da ISR:    ", isrDurationHist);
+        printPercentiles("Leitura (memória): ", memoryLatencyHist);
+    }
+
+    void printStall(const char *cause, unsigned long long cycles)
+    {
+        double share = (totalCycles == 0) ? 0.0 : (double)cycles / totalCycles * 100.0;
+        std::cout << "  " << std::left << std::setw(18) << cause << std::right
+                  << std::setw(10) << cycles << " ciclos (" << share << "%)" << std::endl;
     }
 
     void printReport()
@@ -72,6 +279,55 @@ struct Stats
         std::cout << "Instruções (Ret.):  " << totalInstructions << std::endl;
         std::cout << "IPC (Alto Nível):   " << Color::YELLOW << getIPC() << Color::RESET << " instr/ciclo" << std::endl;
 
+        if (!timingModel.empty())
+        {
+            std::cout << "Modelo de Tempo:    " << timingModel << std::endl;
+            std::cout << "CPI:                " << ((totalInstructions == 0) ? 0.0 : (double)totalCycles / totalInstructions) << std::endl;
+            std::cout << "Stalls por Causa:" << std::endl;
+            printStall("Enchimento", pipelineFillCycles);
+            printStall("Hazard de ACC", stallDataHazard);
+            printStall("Hazard de SP", stallStackHazard);
+            printStall("Memória (IF)", stallFetchMemory);
+            printStall("Memória (MEM)", stallDataMemory);
+            printStall("Desvios", stallBranchFlush);
+            printStall("Interrupções", stallIrqFlush);
+            printStall("Multiciclo (EX)", stallMultiCycle);
+            if (oooRobFullCycles + oooLsqFullCycles + oooStoreForwards + oooMispredictFlushes > 0)
+            {
+                printStall("ROB cheio", oooRobFullCycles);
+                printStall("LSQ cheia", oooLsqFullCycles);
+                std::cout << "  Store->Load Fwd:   " << oooStoreForwards << std::endl;
+                std::cout << "  Flushes (Desvio):  " << oooMispredictFlushes << std::endl;
+            }
+        }
+
+        if (!branchPredictor.empty())
+        {
+            std::cout << "\n"
+                      << Color::CYAN << "--- Predição de Desvios ---" << Color::RESET << std::endl;
+            std::cout << "Preditor:           " << branchPredictor << std::endl;
+            std::cout << "Desvios:            " << branchCount << std::endl;
+            std::cout << "Erros de Predição:  " << Color::RED << branchMispredicts << Color::RESET
+                      << " (" << ((branchCount == 0) ? 0.0 : (double)branchMispredicts / branchCount * 100.0) << "%)" << std::endl;
+            std::cout << "MPKI (Desvios):     " << getBranchMPKI() << std::endl;
+            std::cout << "Penalidade:         " << branchPenaltyCycles << " ciclos" << std::endl;
+
+            // Piores desvios por quantidade de erros
+            std::vector<std::pair<Address, BranchSiteStats>> sites(branchSites.begin(), branchSites.end());
+            std::sort(sites.begin(), sites.end(), [](const std::pair<Address, BranchSiteStats> &a, const std::pair<Address, BranchSiteStats> &b)
+                      { return a.second.mispredicted > b.second.mispredicted; });
+            std::cout << "Por PC (top 8):" << std::endl;
+            for (size_t i = 0; i < sites.size() && i < 8; i++)
+            {
+                const BranchSiteStats &site = sites[i].second;
+                std::cout << "  PC " << std::setw(5) << sites[i].first
+                          << "  exec " << std::setw(6) << site.executed
+                          << "  tomado " << std::setw(6) << site.taken
+                          << "  erros " << std::setw(6) << site.mispredicted
+                          << " (" << (double)site.mispredicted / site.executed * 100.0 << "%)" << std::endl;
+            }
+        }
+
         std::cout << "\n"
                   << Color::CYAN << "--- Memória & Cache ---" << Color::RESET << std::endl;
         std::cout << "Cache Hits:         " << Color::GREEN << cacheHits << Color::RESET << std::endl;
@@ -82,6 +338,76 @@ struct Stats
         std::cout << "AMAT:               " << getAMAT() << " ciclos" << std::endl;
         std::cout << "Ciclos de Espera:   " << busWaitCycles << " (Stall por memória)" << std::endl;
 
+        if (prefetchIssued > 0)
+        {
+            std::cout << "\n"
+                      << Color::CYAN << "--- Prefetch ---" << Color::RESET << std::endl;
+            std::cout << "Emitidos:           " << prefetchIssued << " (descartados: " << prefetchDropped << ")" << std::endl;
+            std::cout << "Úteis:              " << Color::GREEN << prefetchUseful << Color::RESET << std::endl;
+            std::cout << "Atrasados:          " << prefetchLate << std::endl;
+            std::cout << "Poluição:           " << Color::RED << prefetchPolluting << Color::RESET << std::endl;
+            std::cout << "Acurácia:           " << getPrefetchAccuracy() << "%" << std::endl;
+            std::cout << "Cobertura:          " << getPrefetchCoverage() << "%" << std::endl;
+            std::cout << "Banda Consumida:    " << prefetchBusCycles << " ciclos" << std::endl;
+        }
+
+        if (victimInserts > 0)
+        {
+            std::cout << "\n"
+                      << Color::CYAN << "--- Victim Cache ---" << Color::RESET << std::endl;
+            std::cout << "Hits:               " << Color::GREEN << victimHits << Color::RESET
+                      << " (" << ((cacheMisses == 0) ? 0.0 : (double)victimHits / cacheMisses * 100.0)
+                      << "% dos misses)" << std::endl;
+            std::cout << "Swaps:              " << victimSwaps << std::endl;
+            std::cout << "Inserções:          " << victimInserts << " (descartes LRU: " << victimEvictions << ")" << std::endl;
+        }
+
+        if (writeBufferStores > 0)
+        {
+            std::cout << "\n"
+                      << Color::CYAN << "--- Buffer de Escrita ---" << Color::RESET << std::endl;
+            std::cout << "STOREs:             " << writeBufferStores << std::endl;
+            std::cout << "Coalescing:         " << writeBufferCoalesced << " (" << getCoalescingRate() << "%)" << std::endl;
+            std::cout << "Forwarding:         " << writeBufferForwards << " preenchimentos" << std::endl;
+            std::cout << "Buffer Cheio:       " << writeBufferFullEvents << " vezes, "
+                      << Color::RED << writeBufferStallCycles << Color::RESET << " ciclos de stall" << std::endl;
+            std::cout << "Ocupação:          ";
+            for (size_t i = 0; i < writeBufferOccupancy.size(); i++)
+            {
+                std::cout << " [" << i << "]=" << writeBufferOccupancy[i];
+            }
+            std::cout << std::endl;
+        }
+
+        if (!mmuConfig.empty())
+        {
+            std::cout << "\n"
+                      << Color::CYAN << "--- MMU ---" << Color::RESET << std::endl;
+            std::cout << "TLB:                " << mmuConfig << std::endl;
+            std::cout << "TLB Hits:           " << Color::GREEN << tlbHits << Color::RESET
+                      << "  Misses: " << Color::RED << tlbMisses << Color::RESET << std::endl;
+            std::cout << "Taxa de Hit (TLB):  " << getTlbHitRate() << "%" << std::endl;
+            std::cout << "Page Walks:         " << pageWalks << " (" << pageWalkCycles << " ciclos";
+            if (pageWalks > 0)
+                std::cout << ", " << (double)pageWalkCycles / pageWalks << " por walk";
+            std::cout << ")" << std::endl;
+            std::cout << "Falhas de Página:   " << pageFaults << std::endl;
+        }
+
+        std::cout << "\n"
+                  << Color::CYAN << "--- DRAM ---" << Color::RESET << std::endl;
+        std::cout << "Acessos (Burst):    " << dramAccesses << std::endl;
+        std::cout << "Row Hits:           " << Color::GREEN << dramRowHits << Color::RESET
+                  << "  Misses: " << dramRowMisses
+                  << "  Conflitos: " << Color::RED << dramRowConflicts << Color::RESET << std::endl;
+        std::cout << "Taxa de Row Hit:    " << getRowHitRate() << "%" << std::endl;
+        if (dramTurnarounds > 0)
+            std::cout << "Turnaround W->R:    " << dramTurnarounds << " leituras" << std::endl;
+        if (dramAccesses > 0)
+        {
+            std::cout << "Latência Média:     " << (double)dramLatencyCycles / dramAccesses << " ciclos" << std::endl;
+        }
+
         std::cout << "\n"
                   << Color::CYAN << "--- Interrupções (IRQ) ---" << Color::RESET << std::endl;
         std::cout << "IRQs Atendidas:     " << irqCount << std::endl;
@@ -90,9 +416,22 @@ struct Stats
             std::cout << "Latência Média:     " << (double)totalIrqLatency / irqCount << " ciclos" << std::endl;
         }
 
+        printLatencyReport();
+
         std::cout << "\n"
                   << Color::CYAN << "--- Transferência de Dados ---" << Color::RESET << std::endl;
         std::cout << "Cópia via CPU:      " << cpuBytesCopied << " bytes (Load/Store)" << std::endl;
+        if (blockInstructions > 0)
+        {
+            std::cout << "Cópia via Bloco:    " << blockBytesCopied << " bytes (MEMCPY/MEMSET, "
+                      << blockInstructions << " instr, " << blockCycles << " ciclos";
+            if (blockCycles > 0)
+                std::cout << ", " << (double)blockBytesCopied / blockCycles << " bytes/ciclo";
+            std::cout << ")" << std::endl;
+            std::cout << "Comparação (Bloco): " << blockBytesCompared << " bytes (MEMCMP)" << std::endl;
+        }
+        if (simdInstructions > 0)
+            std::cout << "SIMD (4x8 bits):    " << simdInstructions << " instr (PADDB/PXORB)" << std::endl;
         std::cout << "Cópia via DMA:      " << dmaBytesCopied << " bytes (N/A)" << std::endl;
 
         std::cout << "============================================" << std::endl;
@@ -9,12 +9,14 @@ class SystemBus : public IMemoryDevice
 private:
     IMemoryDevice *ram; // Pode ser a Cache ou a RAM direta
     Keyboard *keyboard;
-    Display *display;
+    IMemoryDevice *display; // O Display ou quem o representa (porta do --quantum)
 
 public:
     SystemBus(IMemoryDevice *mainMem, Keyboard *kbd, Display *dsp)
         : ram(mainMem), keyboard(kbd), display(dsp) {}
 
+    void setDisplay(IMemoryDevice *dsp) { display = dsp; }
+
     Word read(Address addr) const override
     {
         if (addr >= 0xF000)
@@ -39,4 +41,20 @@ public:
             ram->write(addr, value);
         }
     }
+
+    // Bursts que ficam inteiros na faixa de memória vão direto para a RAM/Cache.
+    // Se tocarem MMIO, cai no acesso palavra a palavra (efeitos colaterais).
+    unsigned int readBlock(Address addr, Word *dst, size_t count) const override
+    {
+        if (addr + count <= 0xE000)
+            return ram->readBlock(addr, dst, count);
+        return IMemoryDevice::readBlock(addr, dst, count);
+    }
+
+    unsigned int writeBlock(Address addr, const Word *src, size_t count) override
+    {
+        if (addr + count <= 0xE000)
+            return ram->writeBlock(addr, src, count);
+        return IMemoryDevice::writeBlock(addr, src, count);
+    }
 };
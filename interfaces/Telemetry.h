@@ -0,0 +1,224 @@
+#pragma once
+#include "Stats.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Telemetria ao vivo: um instantâneo dos contadores do Stats num segmento de
+// memória compartilhada POSIX (/dev/shm/cpu_sim.<nome>), lido pelo 'monitor'.
+//
+// Protocolo seqlock: o escritor (thread da simulação) deixa 'sequence' ímpar
+// enquanto copia e par ao terminar; o leitor repete se viu ímpar ou se o
+// número mudou durante a cópia. Ninguém trava e a simulação nunca espera.
+struct TelemetryBlock
+{
+    static constexpr uint32_t MAGIC = 0x54454C45; // "TELE"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    std::atomic<uint32_t> finished; // 1 depois do HALT
+    std::atomic<uint64_t> sequence;
+
+    // Campos atômicos relaxados: a ordem vem das barreiras do seqlock
+    std::atomic<uint64_t> hostNanos; // Relógio do host no instantâneo
+    std::atomic<uint64_t> cycles;
+    std::atomic<uint64_t> instructions;
+    std::atomic<uint64_t> cacheHits;
+    std::atomic<uint64_t> cacheMisses;
+    std::atomic<uint64_t> busWaitCycles;
+    std::atomic<uint64_t> irqCount;
+    std::atomic<uint64_t> irqLatency;
+};
+
+// Cópia local e consistente de um TelemetryBlock
+struct TelemetrySnapshot
+{
+    bool finished = false;
+    uint64_t hostNanos = 0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t busWaitCycles = 0;
+    uint64_t irqCount = 0;
+    uint64_t irqLatency = 0;
+};
+
+inline std::string telemetrySegmentName(const std::string &name) { return "/cpu_sim." + name; }
+
+inline uint64_t telemetryNow()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Lado da simulação: cria o segmento e publica no máximo a cada PUBLISH_PERIOD_NS.
+// O relógio do host só é consultado a cada CHECK_INTERVAL passos, então o custo
+// por instrução é um incremento e uma comparação.
+class TelemetryPublisher
+{
+private:
+    static constexpr unsigned int CHECK_INTERVAL = 64;           // Passos entre consultas ao relógio
+    static constexpr uint64_t PUBLISH_PERIOD_NS = 50 * 1000000ULL; // 20 instantâneos por segundo
+
+    TelemetryBlock *block = nullptr;
+    std::string segment;
+    unsigned int sinceCheck = 0;
+    uint64_t lastPublish = 0;
+
+public:
+    TelemetryPublisher() = default;
+    TelemetryPublisher(const TelemetryPublisher &) = delete;
+    TelemetryPublisher &operator=(const TelemetryPublisher &) = delete;
+
+    ~TelemetryPublisher() { close(); }
+
+    bool open(const std::string &name)
+    {
+        segment = telemetrySegmentName(name);
+        int fd = shm_open(segment.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, sizeof(TelemetryBlock)) != 0)
+        {
+            ::close(fd);
+            shm_unlink(segment.c_str());
+            return false;
+        }
+        void *mapped = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            shm_unlink(segment.c_str());
+            return false;
+        }
+        block = new (mapped) TelemetryBlock();
+        block->magic = TelemetryBlock::MAGIC;
+        block->version = TelemetryBlock::VERSION;
+        block->pid = (int32_t)getpid();
+        return true;
+    }
+
+    void close()
+    {
+        if (!block)
+            return;
+        munmap(block, sizeof(TelemetryBlock));
+        shm_unlink(segment.c_str());
+        block = nullptr;
+    }
+
+    bool isOpen() const { return block != nullptr; }
+
+    // Chamado a cada passo: quase sempre só incrementa um contador local
+    void tick(const Stats &stats)
+    {
+        if (!block || ++sinceCheck < CHECK_INTERVAL)
+            return;
+        sinceCheck = 0;
+        if (telemetryNow() - lastPublish >= PUBLISH_PERIOD_NS)
+            publish(stats);
+    }
+
+    void publish(const Stats &stats, bool finished = false)
+    {
+        if (!block)
+            return;
+        lastPublish = telemetryNow();
+        uint64_t seq = block->sequence.load(std::memory_order_relaxed);
+        block->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        block->hostNanos.store(lastPublish, std::memory_order_relaxed);
+        block->cycles.store(stats.totalCycles, std::memory_order_relaxed);
+        block->instructions.store(stats.totalInstructions, std::memory_order_relaxed);
+        block->cacheHits.store(stats.cacheHits, std::memory_order_relaxed);
+        block->cacheMisses.store(stats.cacheMisses, std::memory_order_relaxed);
+        block->busWaitCycles.store(stats.busWaitCycles, std::memory_order_relaxed);
+        block->irqCount.store(stats.irqCount, std::memory_order_relaxed);
+        block->irqLatency.store(stats.totalIrqLatency, std::memory_order_relaxed);
+        if (finished)
+            block->finished.store(1, std::memory_order_relaxed);
+
+        block->sequence.store(seq + 2, std::memory_order_release);
+    }
+};
+
+// Lado do monitor: mapeia somente leitura
+class TelemetryReader
+{
+private:
+    static constexpr int MAX_ATTEMPTS = 100000; // Uma cópia leva nanossegundos
+
+    const TelemetryBlock *block = nullptr;
+
+public:
+    TelemetryReader() = default;
+    TelemetryReader(const TelemetryReader &) = delete;
+    TelemetryReader &operator=(const TelemetryReader &) = delete;
+
+    ~TelemetryReader()
+    {
+        if (block)
+            munmap(const_cast<TelemetryBlock *>(block), sizeof(TelemetryBlock));
+    }
+
+    bool open(const std::string &name)
+    {
+        int fd = shm_open(telemetrySegmentName(name).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+        void *mapped = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+        block = static_cast<const TelemetryBlock *>(mapped);
+        if (block->magic != TelemetryBlock::MAGIC || block->version != TelemetryBlock::VERSION)
+        {
+            munmap(mapped, sizeof(TelemetryBlock));
+            block = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    int pid() const { return block ? block->pid : 0; }
+
+    // Cópia consistente do bloco. Retorna false se o escritor não terminar a
+    // cópia em MAX_ATTEMPTS tentativas (processo morto no meio do publish).
+    bool read(TelemetrySnapshot &snap) const
+    {
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+        {
+            uint64_t before = block->sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield(); // Escritor no meio da cópia
+                continue;
+            }
+
+            snap.hostNanos = block->hostNanos.load(std::memory_order_relaxed);
+            snap.cycles = block->cycles.load(std::memory_order_relaxed);
+            snap.instructions = block->instructions.load(std::memory_order_relaxed);
+            snap.cacheHits = block->cacheHits.load(std::memory_order_relaxed);
+            snap.cacheMisses = block->cacheMisses.load(std::memory_order_relaxed);
+            snap.busWaitCycles = block->busWaitCycles.load(std::memory_order_relaxed);
+            snap.irqCount = block->irqCount.load(std::memory_order_relaxed);
+            snap.irqLatency = block->irqLatency.load(std::memory_order_relaxed);
+            snap.finished = block->finished.load(std::memory_order_relaxed) != 0;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (block->sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,305 @@
+#pragma once
+#include "Machine.h"
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Viagem no tempo: checkpoints periódicos + replay determinístico da entrada.
+//
+// A cada 'interval' passos guarda o estado da máquina (MachineState) e só as
+// páginas da RAM escritas desde o checkpoint anterior. O primeiro checkpoint
+// retido tem a RAM inteira ('base'); os outros são deltas sobre ele.
+// As teclas entram num log com o passo em que chegaram; voltar no tempo é
+// restaurar o checkpoint anterior ao destino e reexecutar até ele, reinjetando
+// as teclas do log, com display e trace mudos e o terminal em espera até alcançar o
+// ponto mais adiantado já executado ('frontier'). Custo: O(intervalo).
+//
+// Posições: "antes da busca do passo s" (como um breakpoint), o que torna
+// reverse-step e reverse-continue simétricos ao s e ao c do monitor.
+class TimeTravel : public IStepHook
+{
+public:
+    struct Config
+    {
+        unsigned long long interval = 10000; // Passos entre checkpoints
+        size_t budgetBytes = 64u << 20;      // Acima disso, o checkpoint mais antigo é fundido na base
+    };
+
+private:
+    struct Checkpoint
+    {
+        MachineState state;
+        std::vector<std::pair<size_t, std::vector<Word>>> pages; // Delta sobre o checkpoint anterior
+        size_t bytes;
+    };
+
+    struct KeyEvent
+    {
+        unsigned long long step; // Passo em cujo tick a tecla entrou
+        char key;
+    };
+
+    Machine &machine;
+    Config config;
+
+    std::vector<Word> base; // RAM no checkpoint mais antigo retido
+    std::deque<Checkpoint> checkpoints;
+    size_t totalBytes = 0;
+    unsigned long long dropped = 0;
+
+    std::vector<KeyEvent> keyLog;
+    size_t replayCursor = 0;        // Próxima tecla do log a reinjetar
+    unsigned long long frontier = 0; // Maior passo já executado ao vivo
+    bool replaying = false;
+    uint32_t traceCategories = 0; // Trace silenciado durante o replay
+
+public:
+    TimeTravel(Machine &target, const Config &cfg) : machine(target), config(cfg)
+    {
+        if (config.interval == 0)
+            config.interval = 1;
+        machine.setStepHook(this);
+        machine.getKeyboard().setKeyListener([this](char key)
+                                             { recordKey(key); });
+        frontier = machine.stepCount();
+        takeCheckpoint();
+    }
+
+    ~TimeTravel()
+    {
+        machine.setStepHook(nullptr);
+        machine.getKeyboard().setKeyListener(nullptr);
+    }
+
+    TimeTravel(const TimeTravel &) = delete;
+    TimeTravel &operator=(const TimeTravel &) = delete;
+
+    // --- Gancho do passo ---
+    void beforeStep() override
+    {
+        unsigned long long done = machine.stepCount();
+        if (done % config.interval == 0 && done > checkpoints.back().state.steps)
+            takeCheckpoint();
+
+        unsigned long long next = done + 1;
+        if (next <= frontier)
+        {
+            setReplaying(true);
+            while (replayCursor < keyLog.size() && keyLog[replayCursor].step == next)
+                machine.feedKeys(std::string(1, keyLog[replayCursor++].key));
+        }
+        else
+        {
+            setReplaying(false);
+            frontier = next;
+        }
+    }
+
+    // --- Navegação ---
+
+    // Primeira posição alcançável (antes da busca)
+    unsigned long long oldestStep() const { return checkpoints.front().state.steps + 1; }
+
+    // Passo cuja busca é a próxima (a posição atual no formato das buscas)
+    unsigned long long currentStep() const
+    {
+        return machine.getCPU().isFetchPending() ? machine.stepCount() : machine.stepCount() + 1;
+    }
+
+    // Volta (ou avança) até antes da busca do passo s
+    bool seekBeforeFetch(unsigned long long s)
+    {
+        if (s < oldestStep())
+            return false;
+        restoreAtOrBefore(s - 1);
+        replayTo(s - 1);
+        if (!machine.isHalted())
+            machine.stepToFetch();
+        return true;
+    }
+
+    // Volta até logo depois do passo s terminar
+    bool seekAfter(unsigned long long s)
+    {
+        if (s < checkpoints.front().state.steps)
+            return false;
+        restoreAtOrBefore(s);
+        replayTo(s);
+        return true;
+    }
+
+    bool reverseStep(unsigned long long n = 1)
+    {
+        unsigned long long current = currentStep();
+        if (current <= n)
+            return false;
+        return seekBeforeFetch(current - n);
+    }
+
+    // Primeiro ponto com ciclo >= 'cycle' (pode avançar além do já executado)
+    bool gotoCycle(unsigned long long cycle)
+    {
+        size_t index = checkpoints.size();
+        while (index > 0 && checkpoints[index - 1].state.stats.totalCycles > cycle)
+            index--;
+        if (index == 0)
+            return false;
+        restore(index - 1);
+        while (!machine.isHalted() && machine.stats().totalCycles < cycle)
+            machine.stepRaw();
+        return true;
+    }
+
+    // Volta até o último breakpoint ou watchpoint antes da posição atual.
+    // Procura de trás para frente, um intervalo entre checkpoints por vez.
+    // Retorna false (e fica no início do histórico) se não achar nenhum.
+    bool reverseContinue()
+    {
+        unsigned long long current = currentStep();
+        unsigned long long limit = current; // Procura em passos < limit
+        for (size_t index = checkpoints.size(); index > 0; index--)
+        {
+            unsigned long long from = checkpoints[index - 1].state.steps;
+            if (from + 1 >= limit)
+                continue;
+            restore(index - 1);
+
+            unsigned long long hitStep = 0;
+            bool hitIsBreak = false;
+            machine.consumeStop();
+            while (!machine.isHalted() && machine.stepCount() + 1 < limit)
+            {
+                unsigned long long s = machine.stepCount() + 1;
+                if (machine.step()) // Parou antes da busca de s
+                {
+                    hitStep = s;
+                    hitIsBreak = true;
+                    machine.step(); // Retoma o mesmo passo
+                }
+                if (machine.consumeStop() && s + 1 < current)
+                {
+                    hitStep = s;
+                    hitIsBreak = false;
+                }
+            }
+            if (hitStep != 0)
+                return hitIsBreak ? seekBeforeFetch(hitStep) : seekAfter(hitStep);
+            limit = from + 1;
+        }
+        seekBeforeFetch(oldestStep());
+        return false;
+    }
+
+    // --- Informação ---
+    size_t checkpointCount() const { return checkpoints.size(); }
+    size_t memoryBytes() const { return totalBytes + base.size() * sizeof(Word); }
+    unsigned long long droppedCheckpoints() const { return dropped; }
+    unsigned long long oldestCycle() const { return checkpoints.front().state.stats.totalCycles; }
+    unsigned long long frontierStep() const { return frontier; }
+    bool isReplaying() const { return replaying; }
+
+private:
+    void recordKey(char key)
+    {
+        if (replaying)
+            return;
+        keyLog.push_back({machine.stepCount() + 1, key});
+        replayCursor = keyLog.size();
+    }
+
+    void setReplaying(bool value)
+    {
+        if (replaying == value)
+            return;
+        replaying = value;
+        machine.getKeyboard().setPaused(value);
+        machine.getDisplay().setMuted(value);
+        if (Tracer *tracer = machine.getTracer())
+        {
+            if (value)
+            {
+                traceCategories = tracer->enabledCategories();
+                tracer->disable(traceCategories);
+            }
+            else
+                tracer->enable(traceCategories);
+        }
+    }
+
+    void takeCheckpoint()
+    {
+        Ram &ram = machine.getRam();
+        Checkpoint cp{machine.saveState(), {}, sizeof(Checkpoint)};
+        if (checkpoints.empty())
+        {
+            base.assign(ram.pageData(0), ram.pageData(0) + ram.size());
+        }
+        else
+        {
+            for (size_t page = 0; page < ram.pageCount(); page++)
+            {
+                if (!ram.isDirty(page))
+                    continue;
+                cp.pages.emplace_back(page, std::vector<Word>(ram.pageData(page), ram.pageData(page) + Ram::PAGE_WORDS));
+                cp.bytes += Ram::PAGE_WORDS * sizeof(Word) + sizeof(cp.pages.back());
+            }
+        }
+        cp.bytes += cp.state.cacheLines.size() * (sizeof(CacheLine) + 4 * sizeof(Word)) +
+                    cp.state.cpu.isrFrames.size() * 16 + cp.state.keys.size() + cp.state.displayText.size();
+        ram.clearDirty();
+        totalBytes += cp.bytes;
+        checkpoints.push_back(std::move(cp));
+
+        // Orçamento: funde o mais antigo na base (o segundo passa a ser o início)
+        while (totalBytes > config.budgetBytes && checkpoints.size() > 1)
+        {
+            Checkpoint &next = checkpoints[1];
+            for (const auto &page : next.pages)
+                std::copy(page.second.begin(), page.second.end(), base.begin() + page.first * Ram::PAGE_WORDS);
+            totalBytes -= checkpoints.front().bytes;
+            for (const auto &page : next.pages)
+                next.bytes -= Ram::PAGE_WORDS * sizeof(Word) + sizeof(page);
+            totalBytes -= next.pages.size() * (Ram::PAGE_WORDS * sizeof(Word) + sizeof(next.pages.front()));
+            next.pages.clear();
+            checkpoints.pop_front();
+            dropped++;
+        }
+    }
+
+    // Restaura o checkpoint 'index': base + deltas até ele
+    void restore(size_t index)
+    {
+        Ram &ram = machine.getRam();
+        std::vector<Word> image = base;
+        for (size_t i = 1; i <= index; i++)
+        {
+            for (const auto &page : checkpoints[i].pages)
+                std::copy(page.second.begin(), page.second.end(), image.begin() + page.first * Ram::PAGE_WORDS);
+        }
+        std::copy(image.begin(), image.end(), ram.pageData(0));
+        ram.clearDirty();
+
+        machine.restoreState(checkpoints[index].state);
+        unsigned long long step = checkpoints[index].state.steps;
+        replayCursor = 0;
+        while (replayCursor < keyLog.size() && keyLog[replayCursor].step <= step)
+            replayCursor++;
+        setReplaying(step < frontier);
+    }
+
+    // Checkpoint mais recente com steps <= 'step'
+    void restoreAtOrBefore(unsigned long long step)
+    {
+        size_t index = checkpoints.size();
+        while (index > 1 && checkpoints[index - 1].state.steps > step)
+            index--;
+        restore(index - 1);
+    }
+
+    void replayTo(unsigned long long step)
+    {
+        while (!machine.isHalted() && machine.stepCount() < step)
+            machine.stepRaw();
+    }
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include "Types.h"
+
+// Registro de uma instrução aposentada pela CPU funcional (retire trace).
+// Os modelos de tempo só olham para isto: a execução de verdade continua
+// sendo feita pela CPU com Registers/ALU/InstructionDecoder.
+struct RetiredInstruction
+{
+    Address pc = 0;          // Endereço da instrução
+    Address nextPC = 0;      // PC depois da execução
+    InstructionType type = InstructionType::HALT;
+    bool isAddressMode = false;
+    uint32_t operand = 0;
+    bool branchTaken = false; // JUMP/CALL/RET, ou JEQ com Z=1
+    bool irqEntry = false;    // Uma interrupção foi aceita antes desta instrução
+    Address irqReturn = 0;    // PC interrompido (empilhado na entrada da ISR)
+    Address memAddr = 0;      // Endereço de dados acessado (se houver)
+    bool memRead = false;
+    bool memWrite = false;
+    unsigned int fetchStall = 0; // Ciclos de memória na busca da instrução
+    unsigned int dataStall = 0;  // Ciclos de memória no acesso a dados
+    unsigned int execLatency = 1; // Ciclos no EX (operações em bloco levam mais de 1)
+
+    // Dependências de registrador de cada tipo (Pipeline e OoO usam as mesmas listas)
+    static bool readsACC(InstructionType type)
+    {
+        switch (type)
+        {
+        case InstructionType::ADD:
+        case InstructionType::SUB:
+        case InstructionType::AND:
+        case InstructionType::XOR:
+        case InstructionType::SLT:
+        case InstructionType::STORE:
+        case InstructionType::PUSH:
+        case InstructionType::JEQ: // Lê a flag Z, que vem do ACC
+        case InstructionType::MEMSET:
+        case InstructionType::PADDB:
+        case InstructionType::PXORB:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool writesACC(InstructionType type)
+    {
+        switch (type)
+        {
+        case InstructionType::LOAD:
+        case InstructionType::ADD:
+        case InstructionType::SUB:
+        case InstructionType::AND:
+        case InstructionType::XOR:
+        case InstructionType::SLT:
+        case InstructionType::POP:
+        case InstructionType::MEMCMP:
+        case InstructionType::PADDB:
+        case InstructionType::PXORB:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool usesSP(InstructionType type)
+    {
+        return type == InstructionType::PUSH || type == InstructionType::POP ||
+               type == InstructionType::CALL || type == InstructionType::RET;
+    }
+};
+
+// Interface dos modelos de tempo plugáveis na CPU.
+// Quando há um modelo ligado, é ele quem avança stats->totalCycles.
+class ITimingModel
+{
+public:
+    virtual ~ITimingModel() = default;
+
+    virtual const char *name() const = 0;
+
+    // Contabiliza a instrução e devolve quantos ciclos o relógio avançou
+    virtual unsigned int retire(const RetiredInstruction &instr) = 0;
+
+    // Fim da simulação: esvazia estruturas internas (ex: ROB)
+    virtual void finish() {}
+};
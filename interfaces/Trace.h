@@ -0,0 +1,418 @@
+#pragma once
+#include "Types.h"
+#include "Colors.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// --- Categorias de Trace (bitmask, habilitadas em tempo de execução) ---
+namespace TraceCategory
+{
+    const uint32_t NONE = 0;
+    const uint32_t CACHE = 1u << 0; // HIT / MISS / UPDATE / BYPASS
+    const uint32_t IRQ = 1u << 1;   // Interrupções aceitas pela CPU
+    const uint32_t ALL = 0xFFFFFFFFu;
+}
+
+// Tipos de evento gravados no registro binário
+enum class TraceEvent : uint8_t
+{
+    CACHE_HIT = 0x01,
+    CACHE_MISS = 0x02,
+    CACHE_UPDATE = 0x03,
+    CACHE_BYPASS = 0x04,
+    IRQ_ACCEPT = 0x10
+};
+
+// Registro binário de tamanho fixo (24 bytes).
+// É isso que vai para o arquivo: nada de texto no caminho quente.
+struct TraceRecord
+{
+    uint64_t cycle; // Ciclo global no momento do evento
+    uint32_t pc;    // PC da instrução em execução
+    uint32_t addr;  // Endereço acessado (quando aplicável)
+    uint32_t aux;   // Dado extra (base do bloco, vetor da IRQ...)
+    uint16_t aux2;  // Dado extra curto (tamanho do bloco...)
+    uint8_t type;   // TraceEvent
+    uint8_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord deve ter 24 bytes");
+
+// Buffer circular lock-free (um produtor, um consumidor).
+// O produtor é a thread da simulação; o consumidor é a thread de drenagem.
+class TraceRing
+{
+private:
+    static const size_t CAPACITY = 1 << 16; // Potência de 2 (máscara barata)
+    std::unique_ptr<TraceRecord[]> records;
+    std::atomic<size_t> head{0}; // Próxima posição de escrita (produtor)
+    std::atomic<size_t> tail{0}; // Próxima posição de leitura (consumidor)
+
+public:
+    std::atomic<unsigned long long> dropped{0}; // Registros perdidos por buffer cheio
+
+    TraceRing() : records(new TraceRecord[CAPACITY]) {}
+
+    // Nunca bloqueia: se o buffer estiver cheio, descarta e contabiliza
+    bool push(const TraceRecord &rec)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= CAPACITY)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        records[h & (CAPACITY - 1)] = rec;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Copia até 'max' registros para 'out'. Retorna quantos foram lidos.
+    size_t drain(TraceRecord *out, size_t max)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (t != h && count < max)
+        {
+            out[count++] = records[t & (CAPACITY - 1)];
+            t++;
+        }
+        tail.store(t, std::memory_order_release);
+        return count;
+    }
+};
+
+class Tracer
+{
+private:
+    // Máscara de categorias ativas (pode mudar em tempo de execução)
+    std::atomic<uint32_t> categories;
+
+    // Fonte do relógio global e PC atual (atualizado pela CPU)
+    const unsigned long long *cycleSource;
+    Address currentPC = 0;
+
+    // Identidade única por instância (nunca reusada, ao contrário do endereço):
+    // chave do cache por thread do localRing()
+    const unsigned long long id = nextId().fetch_add(1, std::memory_order_relaxed);
+
+    // Um ring por thread produtora
+    std::mutex ringsMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<TraceRing>> rings;
+
+    // Destino: arquivo binário ou texto colorido ao vivo (stdout)
+    FILE *outFile = nullptr;
+    bool liveText = false;
+
+    std::thread drainThread;
+    std::atomic<bool> running{false};
+
+    static constexpr char MAGIC[8] = {'S', 'I', 'M', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t VERSION = 1;
+
+public:
+    Tracer(uint32_t enabledCategories = TraceCategory::NONE, const unsigned long long *cyclePtr = nullptr)
+        : categories(enabledCategories), cycleSource(cyclePtr) {}
+
+    ~Tracer()
+    {
+        stop();
+        // Os caches de outras threads nunca mais casam com este id; o desta é limpo
+        RingCache &cache = ringCache();
+        for (size_t i = 0; i < RingCache::SLOTS; i++)
+        {
+            if (cache.owner[i] == id)
+            {
+                cache.owner[i] = 0;
+                cache.ring[i] = nullptr;
+            }
+        }
+    }
+
+    // --- Configuração do destino ---
+
+    // Grava registros binários em arquivo (para o subcomando 'decode')
+    bool openFile(const std::string &path)
+    {
+        outFile = std::fopen(path.c_str(), "wb");
+        if (!outFile)
+            return false;
+
+        uint32_t recordSize = sizeof(TraceRecord);
+        std::fwrite(MAGIC, 1, sizeof(MAGIC), outFile);
+        std::fwrite(&VERSION, sizeof(VERSION), 1, outFile);
+        std::fwrite(&recordSize, sizeof(recordSize), 1, outFile);
+        return true;
+    }
+
+    // Renderiza como texto colorido em stdout, mas fora da thread da simulação
+    void useLiveText() { liveText = true; }
+
+    void start()
+    {
+        if (running.exchange(true))
+            return;
+        drainThread = std::thread([this]()
+                                  { drainLoop(); });
+    }
+
+    void stop()
+    {
+        if (!running.exchange(false))
+            return;
+        drainThread.join();
+        drainAll(); // Última passada para não perder o final
+        if (outFile)
+        {
+            std::fclose(outFile);
+            outFile = nullptr;
+        }
+        std::cout << std::flush;
+    }
+
+    // --- Controle de Categorias ---
+    bool enabled(uint32_t category) const
+    {
+        return (categories.load(std::memory_order_relaxed) & category) != 0;
+    }
+    void enable(uint32_t category) { categories.fetch_or(category, std::memory_order_relaxed); }
+    void disable(uint32_t category) { categories.fetch_and(~category, std::memory_order_relaxed); }
+    uint32_t enabledCategories() const { return categories.load(std::memory_order_relaxed); }
+
+    void setPC(Address pc) { currentPC = pc; }
+
+    // Relógio definido depois da construção (a máquina dona do Stats nasce depois do Tracer)
+    void setCycleSource(const unsigned long long *cyclePtr) { cycleSource = cyclePtr; }
+
+    unsigned long long getDropped()
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        unsigned long long total = 0;
+        for (auto &entry : rings)
+            total += entry.second->dropped.load();
+        return total;
+    }
+
+    // --- Caminho Quente ---
+    // Monta o registro e empurra no ring da thread atual (sem lock, sem I/O)
+    void emit(TraceEvent type, Address addr, uint32_t aux = 0, uint16_t aux2 = 0)
+    {
+        TraceRecord rec;
+        rec.cycle = cycleSource ? *cycleSource : 0;
+        rec.pc = currentPC;
+        rec.addr = addr;
+        rec.aux = aux;
+        rec.aux2 = aux2;
+        rec.type = (uint8_t)type;
+        rec.reserved = 0;
+        localRing()->push(rec);
+    }
+
+    // Converte "cache,irq" / "all" / "none" em máscara de categorias
+    static uint32_t parseCategories(const std::string &list)
+    {
+        uint32_t mask = TraceCategory::NONE;
+        size_t start = 0;
+        while (start <= list.size())
+        {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos)
+                end = list.size();
+            std::string name = list.substr(start, end - start);
+
+            if (name == "cache")
+                mask |= TraceCategory::CACHE;
+            else if (name == "irq")
+                mask |= TraceCategory::IRQ;
+            else if (name == "all")
+                mask |= TraceCategory::ALL;
+            else if (!name.empty() && name != "none")
+                std::cerr << "[Trace] Categoria desconhecida: " << name << std::endl;
+
+            start = end + 1;
+        }
+        return mask;
+    }
+
+    // --- Renderização (compartilhada entre modo ao vivo e 'decode') ---
+    static std::string render(const TraceRecord &rec, bool withTimestamp)
+    {
+        std::string prefix;
+        if (withTimestamp)
+        {
+            prefix = "[" + std::to_string(rec.cycle) + " | PC " + std::to_string(rec.pc) + "] ";
+        }
+
+        switch ((TraceEvent)rec.type)
+        {
+        case TraceEvent::CACHE_HIT:
+            return prefix + Color::GREEN + "[CACHE HIT]  Addr: " + std::to_string(rec.addr) + Color::RESET;
+
+        case TraceEvent::CACHE_MISS:
+            return prefix + Color::RED + "[CACHE MISS] Addr: " + std::to_string(rec.addr) +
+                   " -> Buscando Bloco [" + std::to_string(rec.aux) +
+                   " a " + std::to_string(rec.aux + rec.aux2 - 1) + "]..." + Color::RESET;
+
+        case TraceEvent::CACHE_UPDATE:
+            return prefix + "[CACHE UPDATE] Addr: " + std::to_string(rec.addr) + " (Write-Through)";
+
+        case TraceEvent::CACHE_BYPASS:
+            return prefix + "[CACHE BYPASS] Addr: " + std::to_string(rec.addr) + " (Write-Through)";
+
+        case TraceEvent::IRQ_ACCEPT:
+            return prefix + Color::MAGENTA + Color::BOLD +
+                   "[CPU] INTERRUPT DETECTED! Vector: " + std::to_string(rec.aux) +
+                   " (Interrupts Disabled)" + Color::RESET;
+
+        default:
+            return prefix + "[TRACE] Evento desconhecido: " + std::to_string((int)rec.type);
+        }
+    }
+
+    // Subcomando 'decode': lê o arquivo binário e imprime o texto colorido
+    static bool decodeFile(const std::string &path, std::ostream &out)
+    {
+        FILE *in = std::fopen(path.c_str(), "rb");
+        if (!in)
+        {
+            std::cerr << Color::RED << "Erro: Trace nao encontrado: " << path << Color::RESET << std::endl;
+            return false;
+        }
+
+        char magic[8];
+        uint32_t version = 0;
+        uint32_t recordSize = 0;
+        if (std::fread(magic, 1, sizeof(magic), in) != sizeof(magic) ||
+            std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            std::fread(&version, sizeof(version), 1, in) != 1 ||
+            std::fread(&recordSize, sizeof(recordSize), 1, in) != 1 ||
+            version != VERSION || recordSize != sizeof(TraceRecord))
+        {
+            std::cerr << Color::RED << "Erro: Formato de trace invalido." << Color::RESET << std::endl;
+            std::fclose(in);
+            return false;
+        }
+
+        std::vector<TraceRecord> batch(4096);
+        size_t count;
+        while ((count = std::fread(batch.data(), sizeof(TraceRecord), batch.size(), in)) > 0)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                out << render(batch[i], true) << '\n';
+            }
+        }
+        out << std::flush;
+        std::fclose(in);
+        return true;
+    }
+
+private:
+    // Cache por thread dos rings dos últimos Tracers usados: evita lock no caminho
+    // quente, mesmo alternando entre algumas máquinas na mesma thread
+    struct RingCache
+    {
+        static constexpr size_t SLOTS = 4;
+        unsigned long long owner[SLOTS] = {}; // Id do Tracer (0 = vazio)
+        TraceRing *ring[SLOTS] = {};
+        size_t next = 0; // Próximo slot substituído (round-robin)
+    };
+
+    static RingCache &ringCache()
+    {
+        thread_local RingCache cache;
+        return cache;
+    }
+
+    static std::atomic<unsigned long long> &nextId()
+    {
+        static std::atomic<unsigned long long> counter{1};
+        return counter;
+    }
+
+    TraceRing *localRing()
+    {
+        RingCache &cache = ringCache();
+        for (size_t i = 0; i < RingCache::SLOTS; i++)
+        {
+            if (cache.owner[i] == id)
+                return cache.ring[i];
+        }
+
+        TraceRing *ring;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            auto &slot = rings[std::this_thread::get_id()];
+            if (!slot)
+                slot.reset(new TraceRing());
+            ring = slot.get();
+        }
+        size_t i = cache.next++ % RingCache::SLOTS;
+        cache.owner[i] = id;
+        cache.ring[i] = ring;
+        return ring;
+    }
+
+    void drainLoop()
+    {
+        while (running.load())
+        {
+            if (drainAll() == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    size_t drainAll()
+    {
+        std::vector<TraceRing *> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (auto &entry : rings)
+                snapshot.push_back(entry.second.get());
+        }
+
+        TraceRecord batch[1024];
+        size_t total = 0;
+        for (TraceRing *ring : snapshot)
+        {
+            size_t count;
+            while ((count = ring->drain(batch, 1024)) > 0)
+            {
+                write(batch, count);
+                total += count;
+            }
+        }
+        return total;
+    }
+
+    void write(const TraceRecord *batch, size_t count)
+    {
+        if (outFile)
+        {
+            std::fwrite(batch, sizeof(TraceRecord), count, outFile);
+        }
+        if (liveText)
+        {
+            std::string text;
+            for (size_t i = 0; i < count; i++)
+            {
+                text += render(batch[i], false);
+                text += '\n';
+            }
+            std::cout << text << std::flush; // Um flush por lote, não por acesso
+        }
+    }
+};
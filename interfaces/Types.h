@@ -22,5 +22,16 @@ enum class InstructionType : uint8_t
     PUSH = 0x0A,  // Põe ACC na pilha
     POP = 0x0B,   // Tira da pilha para ACC
     CALL = 0x0C,  // Pula e salva PC na pilha
-    RET = 0x0D    // Retorna (Tira PC da pilha)
+    RET = 0x0D,   // Retorna (Tira PC da pilha)
+
+    // --- Operações em Bloco (ponteiros SRC/DST, tamanho em palavras no operando) ---
+    SETSRC = 0x0E, // SRC = Operando
+    SETDST = 0x0F, // DST = Operando
+    MEMCPY = 0x10, // Copia N palavras de [SRC] para [DST]; SRC += N, DST += N
+    MEMSET = 0x11, // Preenche N palavras em [DST] com o ACC; DST += N
+    MEMCMP = 0x12, // Compara N palavras: ACC = 0 se iguais, senão índice da 1ª diferença + 1
+
+    // --- SIMD no ACC (4 lanes de 8 bits) ---
+    PADDB = 0x13, // Soma byte a byte (sem vai-um entre lanes)
+    PXORB = 0x14  // XOR byte a byte (imediato: byte replicado nas 4 lanes)
 };
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+#include "Types.h"
+#include "Stats.h"
+#include <cstring>
+#include <vector>
+
+// Victim Cache (Jouppi): pequena cache totalmente associativa que guarda as
+// linhas expulsas da Cache de mapeamento direto. Num miss, se o bloco estiver
+// aqui, as duas linhas trocam de lugar em vez de ir à RAM.
+class VictimCache
+{
+private:
+    struct Entry
+    {
+        bool valid = false;
+        uint32_t blockAddr = 0;
+        std::vector<Word> data;
+        unsigned long long lastUse = 0; // Para a substituição LRU
+    };
+
+    std::vector<Entry> entries;
+    size_t blockSize;
+    Stats *stats;
+    unsigned long long useClock = 0;
+
+public:
+    VictimCache(size_t entriesCount = 4, size_t wordsPerBlock = 4, Stats *s = nullptr)
+        : blockSize(wordsPerBlock), stats(s)
+    {
+        entries.resize(entriesCount);
+        for (auto &entry : entries)
+        {
+            entry.data.resize(blockSize, 0);
+        }
+    }
+
+    // Procura o bloco; se achar, copia para 'out' e libera a entrada (swap)
+    bool take(uint32_t blockAddr, Word *out)
+    {
+        for (auto &entry : entries)
+        {
+            if (entry.valid && entry.blockAddr == blockAddr)
+            {
+                std::memcpy(out, entry.data.data(), blockSize * sizeof(Word));
+                entry.valid = false;
+                if (stats)
+                    stats->victimHits++;
+                return true;
+            }
+        }
+        if (stats)
+            stats->victimMisses++;
+        return false;
+    }
+
+    // Recebe uma linha expulsa da Cache (substitui a menos usada).
+    // Se o bloco já tem entrada, ela é sobrescrita: duas cópias do mesmo bloco
+    // ficariam divergentes (update só corrige a primeira).
+    void insert(uint32_t blockAddr, const Word *data)
+    {
+        Entry *slot = nullptr;
+        for (auto &entry : entries)
+        {
+            if (entry.valid && entry.blockAddr == blockAddr)
+            {
+                slot = &entry;
+                break;
+            }
+        }
+        if (!slot)
+        {
+            slot = &entries[0];
+            for (auto &entry : entries)
+            {
+                if (!entry.valid)
+                {
+                    slot = &entry;
+                    break;
+                }
+                if (entry.lastUse < slot->lastUse)
+                    slot = &entry;
+            }
+        }
+
+        if (stats)
+        {
+            stats->victimInserts++;
+            if (slot->valid && slot->blockAddr != blockAddr)
+                stats->victimEvictions++;
+        }
+
+        slot->valid = true;
+        slot->blockAddr = blockAddr;
+        slot->lastUse = ++useClock;
+        std::memcpy(slot->data.data(), data, blockSize * sizeof(Word));
+    }
+
+    // O bloco voltou para a Cache por outro caminho (prefetch): a cópia daqui sai
+    void invalidate(uint32_t blockAddr)
+    {
+        for (auto &entry : entries)
+        {
+            if (entry.valid && entry.blockAddr == blockAddr)
+            {
+                entry.valid = false;
+                return;
+            }
+        }
+    }
+
+    // Write-Through: mantém a cópia da vítima coerente com a RAM
+    void update(Address addr, Word value)
+    {
+        uint32_t blockAddr = addr / blockSize;
+        for (auto &entry : entries)
+        {
+            if (entry.valid && entry.blockAddr == blockAddr)
+            {
+                entry.data[addr % blockSize] = value;
+                return;
+            }
+        }
+    }
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include "IMemoryDevice.h"
+#include "Stats.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+// Buffer de escrita da Cache Write-Through.
+// Os STOREs entram aqui em vez de irem direto para a RAM. Escritas no mesmo
+// bloco se juntam numa única entrada (coalescing) e a entrada da frente é
+// drenada para a RAM em segundo plano, ocupando o barramento pelo tempo que a
+// DRAM disser. Se o buffer enche, a CPU paga o stall até a frente liberar.
+class WriteBuffer
+{
+private:
+    struct Entry
+    {
+        uint32_t blockAddr;
+        std::vector<Word> data;
+        std::vector<uint8_t> pending; // pending[i] = palavra i do bloco está pendente (qualquer tamanho de bloco)
+        size_t pendingCount = 0;
+        bool draining = false;  // Já foi enviada à RAM (não aceita mais coalescing)
+        unsigned long long enqueueCycle = 0;
+        unsigned long long doneCycle = 0;
+    };
+
+    IMemoryDevice *ram;
+    Stats *stats;
+    size_t depth;
+    size_t blockSize;
+    std::deque<Entry> entries;
+    unsigned long long busFreeCycle = 0; // Quando o barramento termina a última drenagem
+
+    // Sem modelo de tempo, o relógio global não avança durante os stalls que
+    // este buffer cobra; somamos o atraso acumulado para manter o tempo coerente.
+    // Com pipeline, o relógio já inclui os stalls e o deslocamento fica desligado.
+    unsigned long long stallOffset = 0;
+    bool clockIncludesStalls = false;
+
+public:
+    WriteBuffer(IMemoryDevice *memory, Stats *s, size_t entriesCount = 4, size_t wordsPerBlock = 4)
+        : ram(memory), stats(s), depth(entriesCount), blockSize(wordsPerBlock)
+    {
+        if (stats)
+            stats->writeBufferOccupancy.assign(depth + 1, 0);
+    }
+
+    size_t occupancy() const { return entries.size(); }
+
+    void setClockIncludesStalls(bool value) { clockIncludesStalls = value; }
+
+    // STORE vindo da Cache. Retorna os ciclos de stall (buffer cheio).
+    unsigned int push(Address addr, Word value, unsigned long long now)
+    {
+        now += stallOffset;
+        advanceLocal(now);
+
+        if (stats)
+        {
+            stats->writeBufferStores++;
+            stats->writeBufferOccupancy[entries.size()]++;
+        }
+
+        uint32_t blockAddr = addr / blockSize;
+        uint32_t offset = addr % blockSize;
+
+        // Coalescing: junta com uma entrada do mesmo bloco que ainda não saiu
+        for (auto &entry : entries)
+        {
+            if (entry.blockAddr == blockAddr && !entry.draining)
+            {
+                entry.data[offset] = value;
+                markPending(entry, offset);
+                if (stats)
+                    stats->writeBufferCoalesced++;
+                return 0;
+            }
+        }
+
+        // Buffer cheio: espera a entrada da frente terminar de drenar
+        unsigned int stall = 0;
+        if (entries.size() >= depth)
+        {
+            unsigned long long freeAt = entries.front().doneCycle;
+            stall = (unsigned int)(freeAt > now ? freeAt - now : 0);
+            now += stall;
+            if (!clockIncludesStalls)
+                stallOffset += stall;
+            advanceLocal(now);
+            if (stats)
+            {
+                stats->writeBufferFullEvents++;
+                stats->writeBufferStallCycles += stall;
+            }
+        }
+
+        Entry entry;
+        entry.blockAddr = blockAddr;
+        entry.enqueueCycle = now;
+        entry.data.assign(blockSize, 0);
+        entry.data[offset] = value;
+        entry.pending.assign(blockSize, 0);
+        markPending(entry, offset);
+        entries.push_back(entry);
+
+        advanceLocal(now); // Se o barramento estava livre, começa a drenar já
+        return stall;
+    }
+
+    // Load forwarding: aplica sobre um bloco recém-lido da RAM as palavras
+    // ainda pendentes no buffer. Retorna true se alguma palavra foi repassada.
+    bool forward(uint32_t blockAddr, Word *block)
+    {
+        bool forwarded = false;
+        for (const auto &entry : entries)
+        {
+            if (entry.blockAddr != blockAddr)
+                continue;
+            for (size_t i = 0; i < blockSize; i++)
+            {
+                if (entry.pending[i])
+                {
+                    block[i] = entry.data[i];
+                    forwarded = true;
+                }
+            }
+        }
+        if (forwarded && stats)
+            stats->writeBufferForwards++;
+        return forwarded;
+    }
+
+    // Valor mais recente ainda pendente para 'addr' (inspeção, sem custo nem métrica)
+    bool pendingWord(Address addr, Word &out) const
+    {
+        uint32_t blockAddr = addr / blockSize;
+        uint32_t offset = addr % blockSize;
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        {
+            if (it->blockAddr == blockAddr && it->pending[offset])
+            {
+                out = it->data[offset];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Esvazia tudo imediatamente (DMA, shutdown): ordem dos dados é garantida
+    void drainAll()
+    {
+        for (auto &entry : entries)
+        {
+            if (!entry.draining)
+                flush(entry);
+        }
+        entries.clear();
+    }
+
+private:
+    // --- Drenagem ---
+    // Ninguém chama o buffer a cada ciclo: ao ser consultado em 'now', ele
+    // reconstitui o que drenou em segundo plano. Cada entrada começa quando
+    // chegou ou quando o barramento liberou (o que vier depois), e sai da
+    // frente se terminou até 'now'.
+    void advanceLocal(unsigned long long now)
+    {
+        while (!entries.empty())
+        {
+            Entry &head = entries.front();
+            if (!head.draining)
+            {
+                unsigned long long start = std::max(head.enqueueCycle, busFreeCycle);
+                if (start > now)
+                    break; // Barramento ainda ocupado
+                unsigned int latency = flush(head);
+                head.draining = true;
+                head.doneCycle = start + latency;
+                busFreeCycle = head.doneCycle;
+                if (stats)
+                    stats->writeBufferDrainCycles += latency;
+            }
+            if (head.doneCycle > now)
+                break;
+            entries.pop_front();
+        }
+    }
+
+    static void markPending(Entry &entry, uint32_t offset)
+    {
+        if (!entry.pending[offset])
+        {
+            entry.pending[offset] = 1;
+            entry.pendingCount++;
+        }
+    }
+
+    // Envia a entrada à RAM: bloco completo num burst, senão cada trecho contíguo
+    unsigned int flush(const Entry &entry)
+    {
+        Address base = entry.blockAddr * blockSize;
+        if (entry.pendingCount == blockSize)
+            return ram->writeBlock(base, entry.data.data(), blockSize);
+
+        unsigned int latency = 0;
+        size_t i = 0;
+        while (i < blockSize)
+        {
+            if (!entry.pending[i])
+            {
+                i++;
+                continue;
+            }
+            size_t start = i;
+            while (i < blockSize && entry.pending[i])
+                i++;
+            latency += ram->writeBlock(base + start, entry.data.data() + start, i - start);
+        }
+        return latency;
+    }
+};
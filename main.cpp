@@ -2,7 +2,18 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <unistd.h> // Para usleep
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <unistd.h> // Para sleep (monitor)
+#include <dirent.h>
+#include <cerrno>
+#include <csignal>
 
 // Mantendo o padrão de pastas que você forneceu
 #include "interfaces/Types.h"
@@ -14,126 +25,719 @@
 #include "interfaces/CPU.h"
 #include "interfaces/Assembler.h"
 #include "interfaces/Display.h"
+#include "interfaces/DisplaySink.h"
 #include "interfaces/Colors.h" // Arquivo de Cores
 #include "interfaces/Stats.h"  // Arquivo de Estatísticas
+#include "interfaces/Trace.h"  // Trace binário de eventos
+#include "interfaces/Prefetcher.h"
+#include "interfaces/Pipeline.h"
+#include "interfaces/BranchPredictor.h"
+#include "interfaces/OutOfOrder.h"
+#include "interfaces/Mmu.h"
+#include "interfaces/MappedFile.h"
+#include "interfaces/Preprocessor.h"
+#include "interfaces/ObjectFile.h"
+#include "interfaces/Linker.h"
+#include "interfaces/FirmwareImage.h"
+#include "interfaces/Analyzer.h"
+#include "interfaces/Telemetry.h"
+#include "interfaces/Machine.h"
+#include "interfaces/Debugger.h"
+#include "interfaces/Decoupling.h"
+#include "interfaces/ClockPacer.h"
+
+// Separa o fonte em linhas (caminho antigo do build, usado pelo -O e pelo benchmark)
+std::vector<std::string> splitLines(std::string_view source)
+{
+    std::vector<std::string> lines;
+    std::string text(source);
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Abre o fonte e, se ele usar INCLUDE/MACRO/EQU, expande num buffer.
+// 'source' aponta para o mmap ou para 'storage'.
+bool loadSource(const std::string &path, MappedFile &file, std::string &storage, std::string_view &source)
+{
+    if (!file.open(path))
+    {
+        std::cerr << Color::RED << "Erro: Arquivo fonte nao encontrado: " << path << Color::RESET << std::endl;
+        return false;
+    }
+    source = file.view();
+    if (Preprocessor::needed(source))
+    {
+        Preprocessor preprocessor;
+        if (!preprocessor.processFile(path))
+            return false;
+        storage = preprocessor.result();
+        source = storage;
+    }
+    return true;
+}
+
+// Grava a imagem com seções: os buracos de zeros entre ORGs não vão para o arquivo
+bool saveImage(const char *tag, const std::string &outputBin, const std::vector<Word> &flat)
+{
+    FirmwareImage image = FirmwareImage::fromFlat(flat);
+    if (!image.save(outputBin))
+    {
+        std::cerr << Color::RED << "Erro ao salvar binario." << Color::RESET << std::endl;
+        return false;
+    }
+    std::cout << Color::GREEN << "[" << tag << "] Sucesso! Tamanho do firmware: " << image.totalWords() << " palavras em "
+              << image.segments.size() << " segmento(s), " << image.fileBytes() << " bytes (plano: "
+              << flat.size() * sizeof(Word) << ")." << Color::RESET << std::endl;
+    return true;
+}
 
 // --- COMPILADOR (Host) ---
-void build(const std::string &inputTxt, const std::string &outputBin)
+void build(const std::string &inputTxt, const std::string &outputBin, bool optimize = false)
 {
     std::cout << Color::BLUE << Color::BOLD << "[BUILD] Compilando " << inputTxt << " para " << outputBin << "..." << Color::RESET << std::endl;
 
     Assembler assembler;
-    std::vector<std::string> sourceCode;
-    std::ifstream file(inputTxt);
+    assembler.setOptimize(optimize);
+    MappedFile file;
+    std::string expanded;
+    std::string_view source;
 
-    if (!file.is_open())
-    {
-        std::cerr << Color::RED << "Erro: Arquivo fonte nao encontrado." << Color::RESET << std::endl;
+    if (!loadSource(inputTxt, file, expanded, source))
         return;
+
+    // Gera o vetor binário (com os zeros do ORG preenchidos).
+    // Sem -O, o montador de passo único lê direto do arquivo mapeado;
+    // o otimizador precisa das linhas, então com -O elas são separadas antes.
+    std::vector<Word> binary;
+    if (optimize)
+        binary = assembler.assembleProgram(splitLines(source));
+    else
+        binary = assembler.assembleSource(source);
+
+    if (optimize)
+    {
+        const OptimizerReport &report = assembler.getOptimizerReport();
+        std::cout << Color::YELLOW << "[BUILD] -O: " << report.instructionsBefore << " -> " << report.instructionsAfter
+                  << " instrucoes (" << report.saved() << " economizadas)" << Color::RESET << std::endl;
+        std::cout << "        LOADs removidos: " << report.loadsRemoved
+                  << ", LOADs -> ADD/SUB #: " << report.loadsRewritten
+                  << ", desvios encurtados: " << report.jumpsThreaded
+                  << ", JUMPs removidos: " << report.jumpsRemoved
+                  << ", ADD/SUB # juntados: " << report.immediatesFolded
+                  << ", inalcancaveis: " << report.unreachableRemoved << std::endl;
     }
 
-    std::string line;
-    while (std::getline(file, line))
+    saveImage("BUILD", outputBin, binary);
+}
+
+// --- OBJETOS E LINKER ---
+
+// fonte.txt -> fonte.obj (mesmo diretório)
+std::string objectPathFor(const std::string &source)
+{
+    size_t dot = source.find_last_of('.');
+    size_t slash = source.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return source + ".obj";
+    return source.substr(0, dot) + ".obj";
+}
+
+// Monta um fonte em objeto. Se o .obj existente tem o mesmo hash do fonte
+// (já expandido, com os INCLUDEs), reaproveita sem montar de novo.
+bool compileObject(const std::string &sourcePath, const std::string &objectPath, ObjectFile &object,
+                   std::string &status)
+{
+    MappedFile file;
+    std::string expanded;
+    std::string_view source;
+    if (!loadSource(sourcePath, file, expanded, source))
     {
-        sourceCode.push_back(line);
+        status = "erro";
+        return false;
     }
-    file.close();
 
-    // Gera o vetor binário (com os zeros do ORG preenchidos)
-    std::vector<Word> binary = assembler.assembleProgram(sourceCode);
+    uint64_t hash = ObjectFile::contentHash(source);
+    ObjectFile cached;
+    if (cached.load(objectPath, true) && cached.sourceHash == hash && object.load(objectPath))
+    {
+        status = "sem mudancas (cache)";
+        return true;
+    }
 
-    std::ofstream outFile(outputBin, std::ios::binary);
-    if (outFile.is_open())
+    Assembler assembler;
+    object = assembler.assembleObject(source);
+    object.sourceHash = hash;
+    if (!object.save(objectPath))
     {
-        outFile.write(reinterpret_cast<const char *>(binary.data()), binary.size() * sizeof(Word));
-        outFile.close();
-        std::cout << Color::GREEN << "[BUILD] Sucesso! Tamanho do firmware: " << binary.size() << " palavras." << Color::RESET << std::endl;
+        status = "erro ao gravar " + objectPath;
+        return false;
     }
-    else
+    status = "montado -> " + objectPath;
+    return true;
+}
+
+void compile(const std::string &sourcePath, const std::string &objectPath)
+{
+    ObjectFile object;
+    std::string status;
+    bool ok = compileObject(sourcePath, objectPath, object, status);
+    std::cout << (ok ? Color::GREEN : Color::RED) << "[COMPILE] " << sourcePath << ": " << status << Color::RESET << std::endl;
+}
+
+// Monta os fontes em paralelo (com cache por hash), carrega os .obj prontos
+// e junta tudo numa imagem
+void link(const std::string &outputBin, const std::vector<std::string> &inputs, unsigned int jobs)
+{
+    std::cout << Color::BLUE << Color::BOLD << "[LINK] " << inputs.size() << " entradas -> " << outputBin
+              << " (" << jobs << " threads)" << Color::RESET << std::endl;
+
+    std::vector<ObjectFile> objects(inputs.size());
+    std::vector<std::string> status(inputs.size());
+    std::vector<char> ok(inputs.size(), 0);
+
+    // Cada fonte é independente: as threads pegam o próximo da fila
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
     {
-        std::cerr << Color::RED << "Erro ao salvar binario." << Color::RESET << std::endl;
+        for (size_t i = next++; i < inputs.size(); i = next++)
+        {
+            const std::string &input = inputs[i];
+            bool isObject = input.size() > 4 && input.compare(input.size() - 4, 4, ".obj") == 0;
+            if (isObject)
+            {
+                ok[i] = objects[i].load(input);
+                status[i] = ok[i] ? "objeto" : "objeto invalido";
+            }
+            else
+            {
+                ok[i] = compileObject(input, objectPathFor(input), objects[i], status[i]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < std::min<size_t>(jobs, inputs.size()); t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+
+    bool allOk = true;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        std::cout << (ok[i] ? Color::GREEN : Color::RED) << "  " << inputs[i] << ": " << status[i] << Color::RESET << std::endl;
+        allOk = allOk && ok[i];
+    }
+    if (!allOk)
+        return;
+
+    Linker linker;
+    std::vector<Word> image;
+    if (!linker.link(objects, inputs, image))
+    {
+        std::cerr << Color::RED << "[LINK] Falhou." << Color::RESET << std::endl;
+        return;
     }
+
+    saveImage("LINK", outputBin, image);
 }
 
-// --- MAQUINA VIRTUAL (Target) ---
-// Adicionado parâmetro 'quiet'
-void run(const std::string &firmwareFile, bool quiet)
+// --- BENCHMARK DO MONTADOR ---
+// Compara o montador de dois passos (linhas em vector<string>) com o de passo
+// único (string_view sobre o arquivo mapeado). 'input' é um arquivo fonte ou
+// um número de linhas para gerar um firmware sintético com referências adiante.
+void benchAssembler(const std::string &input)
 {
-    std::cout << Color::BLUE << Color::BOLD << "[RUN] Iniciando Maquina..." << Color::RESET << std::endl;
-    if (quiet)
+    MappedFile file;
+    std::string generated;
+    std::string_view source;
+
+    bool synthetic = !input.empty() && std::all_of(input.begin(), input.end(), ::isdigit);
+    if (synthetic)
     {
-        std::cout << Color::YELLOW << "[INFO] Modo Quiet ativado (Logs de Cache ocultos)." << Color::RESET << std::endl;
+        size_t blocks = std::max<size_t>(1, (size_t)std::atol(input.c_str()) / 5);
+        generated.reserve(blocks * 5 * 16);
+        for (size_t i = 0; i < blocks; i++)
+        {
+            generated += "L" + std::to_string(i) + ":\n";
+            generated += "    LOAD 100\n";
+            generated += "    ADD #1 ; incrementa\n";
+            generated += "    JEQ L" + std::to_string(i + 1) + "\n";
+            generated += "    STORE 100\n";
+        }
+        generated += "L" + std::to_string(blocks) + ":\n    HALT\n";
+        source = generated;
+    }
+    else
+    {
+        if (!file.open(input))
+        {
+            std::cerr << Color::RED << "Erro: Arquivo fonte nao encontrado." << Color::RESET << std::endl;
+            return;
+        }
+        source = file.view();
     }
-    std::cout << "DIGITE AGORA (" << Color::RED << "z" << Color::RESET << " para sair):" << std::endl;
 
-    // 1. Objeto Central de Estatísticas
-    Stats stats;
+    size_t lines = std::count(source.begin(), source.end(), '\n');
+    std::cout << Color::BLUE << Color::BOLD << "[ASM-BENCH] " << (synthetic ? "Fonte sintetico" : input) << ": "
+              << lines << " linhas, " << source.size() / 1024 << " KiB" << Color::RESET << std::endl;
 
-    // 2. Instancia Hardware (Injetando dependência de Stats)
-    Ram ram;
+    // Melhor de 3 execuções para cada montador
+    auto measure = [&](bool singlePass, std::vector<Word> &out)
+    {
+        double best = 1e30;
+        for (int rep = 0; rep < 3; rep++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            Assembler assembler;
+            out = singlePass ? assembler.assembleSource(source) : assembler.assembleProgram(splitLines(source));
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = std::min(best, seconds);
+        }
+        return best;
+    };
 
-    // Cache recebe RAM e Stats.
-    // Atualizado: passamos 4 explicitamente (tamanho da linha) para poder passar !quiet no 5º argumento (verbose)
-    Cache cache(&ram, &stats, 8, 4, !quiet);
+    std::vector<Word> legacy, fast;
+    double legacySeconds = measure(false, legacy);
+    double fastSeconds = measure(true, fast);
 
-    // PIC recebe Stats (para latência de IRQ)
-    PIC pic(&stats);
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "Dois passos:        " << lines / legacySeconds << " linhas/s (" << std::setprecision(3) << legacySeconds * 1000.0 << " ms)" << std::endl;
+    std::cout << std::setprecision(0);
+    std::cout << "Passo unico (mmap): " << Color::GREEN << lines / fastSeconds << Color::RESET << " linhas/s (" << std::setprecision(3) << fastSeconds * 1000.0 << " ms)" << std::endl;
+    std::cout << std::setprecision(2);
+    std::cout << "Ganho:              " << legacySeconds / fastSeconds << "x" << std::endl;
+    std::cout << "Binarios iguais:    " << (legacy == fast ? "sim" : "NAO") << " (" << fast.size() << " palavras)" << std::endl;
+}
 
-    // Keyboard recebe PIC e ponteiro para o ciclo atual (para timestamp do IRQ)
-    Keyboard keyboard(&pic, &stats.totalCycles);
+// --- BENCHMARK DO SIMULADOR ---
+// Roda kernels de firmware (bench/*.txt) sem terminal, sem pausas e sem
+// trace, N vezes cada, e mede o host (ns/instrução, MIPS) e o guest (Stats).
+// 'kernel.in' ao lado do fonte, se existir, é digitado pelo teclado.
 
-    Display display;
+struct BenchResult
+{
+    std::string name;
+    bool finished = false; // Chegou no HALT antes do limite
+    unsigned long long instructions = 0;
+    unsigned long long cycles = 0;
+    double ipc = 0, hitRate = 0, amat = 0;
+    unsigned long long irqCount = 0;
+    double bestNsPerInstruction = 0, meanNsPerInstruction = 0;
+};
+
+// Trava de segurança para kernel que nunca executa HALT
+static constexpr unsigned long long BENCH_MAX_INSTRUCTIONS = 50000000ULL;
 
-    // Barramento conecta tudo
-    SystemBus bus(&cache, &keyboard, &display);
+// Uma execução com a configuração padrão do 'run' (Cache 8x4, sem modelo de tempo)
+double benchOnce(const std::vector<Word> &image, const std::string &keys, Stats &stats, bool &finished)
+{
+    Machine machine;
+    machine.loadImage(image);
+    machine.feedKeys(keys);
+
+    auto start = std::chrono::steady_clock::now();
+    while (!machine.isHalted() && machine.stats().totalInstructions < BENCH_MAX_INSTRUCTIONS)
+        machine.stepN(4096);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    finished = machine.isHalted();
+    machine.finish();
+    stats = machine.stats();
+    return seconds;
+}
 
-    // CPU recebe Barramento, PIC e Stats
-    CPU cpu(&bus, &pic, &stats);
+// Expande diretórios em seus .txt (ordem alfabética)
+std::vector<std::string> benchKernels(const std::vector<std::string> &inputs)
+{
+    std::vector<std::string> kernels;
+    for (const std::string &input : inputs)
+    {
+        DIR *dir = opendir(input.c_str());
+        if (!dir)
+        {
+            kernels.push_back(input);
+            continue;
+        }
+        std::vector<std::string> found;
+        while (dirent *entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                found.push_back(input + "/" + name);
+        }
+        closedir(dir);
+        std::sort(found.begin(), found.end());
+        kernels.insert(kernels.end(), found.begin(), found.end());
+    }
+    return kernels;
+}
 
-    // 3. Carrega Firmware do Disco
-    std::ifstream binFile(firmwareFile, std::ios::binary | std::ios::ate);
-    if (!binFile.is_open())
+void writeBenchJson(const std::string &path, const std::vector<BenchResult> &results, int reps)
+{
+    std::ofstream out(path);
+    if (!out.is_open())
     {
-        std::cerr << Color::RED << "Erro: Firmware nao encontrado: " << firmwareFile << Color::RESET << std::endl;
+        std::cerr << Color::RED << "Erro ao criar " << path << Color::RESET << std::endl;
         return;
     }
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"repetitions\": " << reps << ",\n  \"kernels\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"finished\": " << (r.finished ? "true" : "false")
+            << ", \"instructions\": " << r.instructions << ", \"cycles\": " << r.cycles
+            << ", \"ipc\": " << r.ipc << ", \"hit_rate\": " << r.hitRate << ", \"amat\": " << r.amat
+            << ", \"irqs\": " << r.irqCount
+            << ", \"host_ns_per_instruction\": " << r.bestNsPerInstruction
+            << ", \"host_ns_per_instruction_mean\": " << r.meanNsPerInstruction
+            << ", \"host_mips\": " << (r.bestNsPerInstruction > 0 ? 1000.0 / r.bestNsPerInstruction : 0.0) << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    std::cout << Color::GREEN << "[BENCH] Resultados em " << path << Color::RESET << std::endl;
+}
 
-    std::streamsize sizeBytes = binFile.tellg();
-    binFile.seekg(0, std::ios::beg);
+void bench(const std::vector<std::string> &inputs, int reps, const std::string &jsonPath)
+{
+    std::vector<std::string> kernels = benchKernels(inputs);
+    std::cout << Color::BLUE << Color::BOLD << "[BENCH] " << kernels.size() << " kernels, " << reps << " repeticoes" << Color::RESET << std::endl;
 
-    std::vector<Word> buffer(sizeBytes / sizeof(Word));
-    binFile.read(reinterpret_cast<char *>(buffer.data()), sizeBytes);
+    std::vector<BenchResult> results;
+    for (const std::string &path : kernels)
+    {
+        MappedFile file;
+        std::string expanded;
+        std::string_view source;
+        if (!loadSource(path, file, expanded, source))
+            continue;
+        Assembler assembler;
+        std::vector<Word> image = assembler.assembleSource(source);
 
-    std::cout << Color::BLUE << "[BOOT] Carregando " << buffer.size() << " instrucoes na Memória Principal." << Color::RESET << std::endl;
-    ram.loadProgram(buffer);
+        std::string keys;
+        MappedFile input;
+        if (input.open(path.substr(0, path.size() - 4) + ".in"))
+            keys = std::string(input.view());
 
-    // 4. Executa
-    std::cout << Color::GREEN << Color::BOLD << "[SYSTEM] Power On." << Color::RESET << std::endl;
+        BenchResult result;
+        size_t slash = path.find_last_of('/');
+        result.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+        result.name = result.name.substr(0, result.name.find_last_of('.'));
 
-    // Loop Infinito Interativo
-    // A simulação roda até que o firmware execute HALT (acionado pelo 'z')
-    while (!cpu.isHalted())
+        double best = 1e30, total = 0;
+        for (int rep = 0; rep < reps; rep++)
+        {
+            Stats stats; // Máquina nova a cada repetição: o guest é determinístico
+            double seconds = benchOnce(image, keys, stats, result.finished);
+            double ns = stats.totalInstructions ? seconds * 1e9 / stats.totalInstructions : 0.0;
+            best = std::min(best, ns);
+            total += ns;
+            result.instructions = stats.totalInstructions;
+            result.cycles = stats.totalCycles;
+            result.ipc = stats.getIPC();
+            result.hitRate = stats.getHitRate();
+            result.amat = stats.getAMAT();
+            result.irqCount = stats.irqCount;
+        }
+        result.bestNsPerInstruction = best;
+        result.meanNsPerInstruction = total / reps;
+        results.push_back(result);
+    }
+
+    std::cout << std::left << std::setw(12) << "kernel" << std::right << std::setw(11) << "instr" << std::setw(11) << "ciclos"
+              << std::setw(7) << "IPC" << std::setw(8) << "hit%" << std::setw(7) << "AMAT" << std::setw(10) << "ns/instr"
+              << std::setw(8) << "MIPS" << std::endl;
+    for (const BenchResult &r : results)
+    {
+        std::cout << std::left << std::setw(12) << r.name << std::right << std::setw(11) << r.instructions << std::setw(11) << r.cycles
+                  << std::fixed << std::setprecision(3) << std::setw(7) << r.ipc << std::setprecision(1) << std::setw(8) << r.hitRate
+                  << std::setprecision(2) << std::setw(7) << r.amat << std::setw(10) << r.bestNsPerInstruction
+                  << std::setprecision(1) << std::setw(8) << (r.bestNsPerInstruction > 0 ? 1000.0 / r.bestNsPerInstruction : 0.0);
+        if (!r.finished)
+            std::cout << Color::RED << "  (sem HALT)" << Color::RESET;
+        std::cout << std::endl;
+    }
+
+    if (!jsonPath.empty())
+        writeBenchJson(jsonPath, results, reps);
+}
+
+// --- ANÁLISE ESTÁTICA (WCET) ---
+// Desmonta a imagem, monta o CFG de cada rotina e limita o pior caso.
+// Com --input, roda o firmware sem terminal digitando o arquivo e mostra a
+// latência média de IRQ medida ao lado do limite.
+void analyze(const std::string &firmwareFile, const AnalyzerConfig &config, const std::string &inputFile)
+{
+    ImageLoader loader;
+    if (!loader.open(firmwareFile))
+    {
+        std::cerr << Color::RED << "Erro: " << loader.error() << Color::RESET << std::endl;
+        return;
+    }
+    std::vector<Word> image;
+    for (const auto &segment : loader.segments())
+    {
+        if (segment.load + segment.length > config.ramSize)
+        {
+            std::cerr << Color::RED << "Erro: segmento em " << segment.load << " nao cabe na RAM" << Color::RESET << std::endl;
+            return;
+        }
+        if (image.size() < segment.load + segment.length)
+            image.resize(segment.load + segment.length, 0);
+        std::copy(segment.words, segment.words + segment.length, image.begin() + segment.load);
+    }
+
+    std::cout << Color::BLUE << Color::BOLD << "[ANALYZE] " << firmwareFile << ": " << loader.totalWords()
+              << " palavras, entrada " << loader.entry() << Color::RESET << std::endl;
+
+    WcetAnalyzer analyzer(config);
+    analyzer.analyze(image, loader.entry());
+    analyzer.printReport();
+
+    std::cout << "\n"
+              << Color::BOLD << "--- Latencia de IRQ ---" << Color::RESET << std::endl;
+    WcetBound latency = analyzer.irqLatencyBound();
+    if (latency.bounded)
+        std::cout << "Pior caso:  <= " << latency.clock << " ciclos (clock), <= " << latency.total << " com espera de memoria" << std::endl;
+    else
+        std::cout << "Pior caso:  " << Color::YELLOW << "ilimitado (ISR sem limite)" << Color::RESET << std::endl;
+
+    if (inputFile.empty())
+    {
+        std::cout << "Medida:     (use --input <teclas> para rodar o firmware)" << std::endl;
+        return;
+    }
+    MappedFile input;
+    if (!input.open(inputFile))
     {
-        // Atualiza relógio global para estatísticas
-        stats.totalCycles++;
+        std::cerr << Color::RED << "Erro: entrada nao encontrada: " << inputFile << Color::RESET << std::endl;
+        return;
+    }
+    Stats stats;
+    bool finished = false;
+    benchOnce(image, std::string(input.view()), stats, finished);
+    if (stats.irqCount == 0)
+    {
+        std::cout << "Medida:     nenhuma IRQ atendida" << std::endl;
+        return;
+    }
+    double average = (double)stats.totalIrqLatency / stats.irqCount;
+    std::cout << "Medida:     media " << std::fixed << std::setprecision(2) << average << " ciclos em " << stats.irqCount << " IRQs"
+              << (finished ? "" : " (sem HALT)");
+    if (latency.bounded && average > latency.clock)
+        std::cout << Color::RED << "  ACIMA DO LIMITE" << Color::RESET;
+    std::cout << std::endl;
+}
 
-        // 1. Verifica entrada real do terminal
-        keyboard.tick();
+// Opções do comando 'run'
+struct RunOptions
+{
+    std::string firmwareFile;
+    bool quiet = false;
+    std::string traceFile;       // --trace <arquivo>: grava trace binário
+    std::string traceCategories; // --trace-cat cache,irq: sobrescreve o padrão
+    std::string displayMode = "async"; // --display sync|async|null
+    FlushPolicy displayFlush = FlushPolicy::EVERY_LINE; // --display-flush line|batch|exit
+    MachineConfig machine;         // Hardware: --prefetch, --write-buffer, --victim, --pipeline,
+                                   // --bpred, --ooo, --mmu... (ver MachineConfig)
+    std::string histogramFile;     // --hist <arquivo>: exporta os histogramas de latência
+    std::string telemetryName;     // --telemetry <nome>: contadores ao vivo para o 'monitor'
+    bool debug = false;            // --debug: monitor com breakpoints/watchpoints antes do Power On
+    unsigned long long timeTravelInterval = 0; // --time-travel <passos>: checkpoints (liga o --debug)
+    size_t timeTravelBudgetMB = 64;            // --tt-budget <MB>
+    unsigned long long quantum = 0;            // --quantum <ciclos>: teclado e display em threads próprios
+    double clockHz = -1;                       // --clock-hz: frequência do guest (0 = sem limite; -1 = padrão do modo)
+};
 
-        // 2. Avança a CPU
-        cpu.step();
+// Cria o sink do Display conforme as opções
+std::unique_ptr<DisplaySink> makeDisplaySink(const RunOptions &options)
+{
+    if (options.displayMode == "null")
+        return std::unique_ptr<DisplaySink>(new NullSink());
+    if (options.displayMode == "sync")
+        return std::unique_ptr<DisplaySink>(new ConsoleSink());
+    return std::unique_ptr<DisplaySink>(new AsyncSink(options.displayFlush));
+}
 
-        // 3. Pequena pausa (1ms) para não usar 100% da CPU do seu computador
-        // 700000 (0.7s) é muito lento para digitação em tempo real.
-        // 1000 (1ms) é fluido.
-        if (!quiet)
+// --- MAQUINA VIRTUAL (Target) ---
+void run(const RunOptions &options)
+{
+    const std::string &firmwareFile = options.firmwareFile;
+    bool quiet = options.quiet;
+
+    std::cout << Color::BLUE << Color::BOLD << "[RUN] Iniciando Maquina..." << Color::RESET << std::endl;
+    if (quiet)
+    {
+        std::cout << Color::YELLOW << "[INFO] Modo Quiet ativado (Logs de Cache ocultos)." << Color::RESET << std::endl;
+    }
+    std::cout << "DIGITE AGORA (" << Color::RED << "z" << Color::RESET << " para sair):" << std::endl;
+
+    // Trace de eventos: sem quiet, Cache e IRQ ficam ativos por padrão.
+    // Com --trace vai para arquivo binário; senão, texto colorido ao vivo
+    // renderizado pela thread de drenagem (fora do caminho da simulação).
+    uint32_t categories = quiet ? TraceCategory::NONE : (TraceCategory::CACHE | TraceCategory::IRQ);
+    if (!options.traceCategories.empty())
+    {
+        categories = Tracer::parseCategories(options.traceCategories);
+    }
+    Tracer tracer(categories);
+    if (!options.traceFile.empty())
+    {
+        if (!tracer.openFile(options.traceFile))
         {
-            usleep(200000);
+            std::cerr << Color::RED << "Erro ao criar arquivo de trace: " << options.traceFile << Color::RESET << std::endl;
+            return;
         }
+        std::cout << Color::YELLOW << "[INFO] Trace binario em " << options.traceFile << Color::RESET << std::endl;
+    }
+    else
+    {
+        tracer.useLiveText();
+    }
+
+    // 2. Instancia Hardware: a máquina é dona de tudo (e do Stats)
+    std::unique_ptr<DisplaySink> displaySink = makeDisplaySink(options);
+    MachineConfig config = options.machine;
+    config.useTerminal = true;
+    Machine machine(config, &tracer, displaySink.get());
+    Stats &stats = machine.stats();
+    tracer.setCycleSource(&stats.totalCycles);
+    tracer.start();
+
+    if (config.mmu)
+        std::cout << Color::YELLOW << "[INFO] MMU: TLB " << stats.mmuConfig << Color::RESET << std::endl;
+    if (config.victimEntries > 0)
+        std::cout << Color::YELLOW << "[INFO] Victim Cache: " << config.victimEntries << " entradas" << Color::RESET << std::endl;
+    if (config.writeBufferDepth > 0)
+        std::cout << Color::YELLOW << "[INFO] Buffer de escrita: " << config.writeBufferDepth << " entradas" << Color::RESET << std::endl;
+    if (machine.hasTimingModel())
+        std::cout << Color::YELLOW << "[INFO] Modelo de tempo: " << stats.timingModel << Color::RESET << std::endl;
+    if (machine.getPrefetcher())
+        std::cout << Color::YELLOW << "[INFO] Prefetcher: " << machine.getPrefetcher()->name() << Color::RESET << std::endl;
+
+    // 3. Carrega Firmware do Disco (mapeado; cada segmento vai direto para a RAM)
+    ImageLoader loader;
+    if (!loader.open(firmwareFile))
+    {
+        std::cerr << Color::RED << "Erro: " << loader.error() << Color::RESET << std::endl;
+        return;
+    }
+
+    std::cout << Color::BLUE << "[BOOT] Carregando " << loader.totalWords() << " instrucoes em "
+              << loader.segments().size() << " segmento(s) na Memória Principal"
+              << (loader.isRaw() ? " (imagem crua)" : "") << "." << Color::RESET << std::endl;
+    if (!machine.load(firmwareFile))
+    {
+        std::cerr << Color::RED << "Erro: " << machine.error() << Color::RESET << std::endl;
+        return;
+    }
+
+    // Telemetria opcional (memória compartilhada, lida pelo 'monitor')
+    TelemetryPublisher telemetry;
+    if (!options.telemetryName.empty())
+    {
+        if (telemetry.open(options.telemetryName))
+            std::cout << Color::YELLOW << "[INFO] Telemetria: ./cpu_sim monitor " << options.telemetryName << Color::RESET << std::endl;
         else
+            std::cerr << Color::RED << "Erro ao criar telemetria " << options.telemetryName << Color::RESET << std::endl;
+    }
+
+    // 4. Executa
+    // Monitor de depuração opcional: sem breakpoints armados, a CPU segue no motor normal
+    std::unique_ptr<DebugMonitor> debugger;
+    std::unique_ptr<TimeTravel> travel;
+    if (options.debug)
+    {
+        debugger.reset(new DebugMonitor(machine, true));
+        if (options.timeTravelInterval > 0 && !machine.supportsCheckpoints())
+        {
+            std::cerr << Color::YELLOW << "[INFO] Viagem no tempo so na configuracao padrao (sem --pipeline/--ooo/--bpred/--mmu/"
+                      << "--prefetch/--victim/--write-buffer): desligada." << Color::RESET << std::endl;
+        }
+        else if (options.timeTravelInterval > 0)
         {
-            usleep(5000);
+            TimeTravel::Config config;
+            config.interval = options.timeTravelInterval;
+            config.budgetBytes = options.timeTravelBudgetMB << 20;
+            travel.reset(new TimeTravel(machine, config));
+            debugger->setTimeTravel(travel.get());
+            std::cout << Color::YELLOW << "[INFO] Viagem no tempo: checkpoint a cada " << config.interval << " passos, ate "
+                      << options.timeTravelBudgetMB << " MB" << Color::RESET << std::endl;
         }
+        debugger->prompt("maquina parada no ponto de entrada ('h' para ajuda)");
+    }
+
+    // Desacoplamento temporal: o prompt do --debug também lê o terminal, então não combinam
+    std::unique_ptr<QuantumScheduler> scheduler;
+    if (options.quantum > 0 && options.debug)
+    {
+        std::cerr << Color::YELLOW << "[INFO] --quantum ignorado com --debug (os dois leem o terminal)." << Color::RESET << std::endl;
+    }
+    else if (options.quantum > 0)
+    {
+        scheduler.reset(new QuantumScheduler(machine, options.quantum));
+        std::cout << Color::YELLOW << "[INFO] Desacoplamento temporal: quantum de " << options.quantum
+                  << " ciclos (CPU, teclado e display em threads)" << Color::RESET << std::endl;
+    }
+
+    // Ritmo do relógio: sem --clock-hz mantém o de antes (5 Hz com logs, 200 Hz no quiet)
+    ClockPacer pacer(options.clockHz >= 0 ? options.clockHz : (quiet ? 200 : 5));
+    if (pacer.unthrottled())
+        std::cout << Color::YELLOW << "[INFO] Relogio: sem limite" << Color::RESET << std::endl;
+    else
+        std::cout << Color::YELLOW << "[INFO] Relogio: " << std::fixed << std::setprecision(0) << pacer.targetHz() << " Hz" << Color::RESET << std::endl;
+
+    std::cout << Color::GREEN << Color::BOLD << "[SYSTEM] Power On." << Color::RESET << std::endl;
+    pacer.start(machine.cycle());
+
+    // Loop Infinito Interativo
+    // A simulação roda até que o firmware execute HALT (acionado pelo 'z')
+    while (!machine.isHalted() && !(debugger && debugger->quit()))
+    {
+        // Relógio, entrada real do terminal e uma instrução
+        bool breakHit = machine.step();
+        telemetry.tick(stats);
+        if (scheduler)
+            scheduler->tick();
+        if (debugger)
+            debugger->afterStep(breakHit);
+
+        // Dorme em lotes até o prazo absoluto do ciclo atual
+        pacer.pace(machine.cycle());
+    }
+    double actualHz = pacer.actualHz(machine.cycle());
+
+    // Drena o que sobrou do trace, do buffer de escrita e do Display antes do relatório
+    if (scheduler)
+    {
+        scheduler->stop();
+        std::cout << Color::YELLOW << "[INFO] Quantum " << scheduler->quantumCycles() << ": " << scheduler->quantaRun()
+                  << " fronteiras, " << scheduler->keys() << " teclas, atraso medio " << std::fixed << std::setprecision(1)
+                  << scheduler->averageKeyDelay() << " ciclos ate a entrega" << Color::RESET << std::endl;
+    }
+    std::cout << Color::YELLOW << "[INFO] Relogio: " << std::fixed << std::setprecision(1) << actualHz << " Hz reais";
+    if (!pacer.unthrottled())
+    {
+        std::cout << " de " << pacer.targetHz() << " (" << actualHz / pacer.targetHz() * 100.0 << "%), atraso max "
+                  << std::setprecision(2) << pacer.maxLagNs() / 1e6 << " ms, " << pacer.resyncCount() << " ressincronizacao(oes)";
+    }
+    std::cout << Color::RESET << std::endl;
+    machine.finish();
+    telemetry.publish(stats, true);
+    tracer.stop();
+    displaySink->close();
+    if (options.displayMode == "null")
+    {
+        std::cout << Color::YELLOW << "[DISPLAY] Modo headless: " << displaySink->bytesWritten() << " bytes descartados." << Color::RESET << std::endl;
+    }
+    if (tracer.getDropped() > 0)
+    {
+        std::cout << Color::YELLOW << "[TRACE] Registros descartados (buffer cheio): " << tracer.getDropped() << Color::RESET << std::endl;
     }
 
     std::cout << "\n"
@@ -141,13 +745,104 @@ void run(const std::string &firmwareFile, bool quiet)
 
     // 5. Imprime Relatório Final
     stats.printReport();
+
+    if (!options.histogramFile.empty())
+    {
+        if (stats.saveHistograms(options.histogramFile))
+            std::cout << Color::YELLOW << "[INFO] Histogramas em " << options.histogramFile << Color::RESET << std::endl;
+        else
+            std::cerr << Color::RED << "Erro ao gravar " << options.histogramFile << Color::RESET << std::endl;
+    }
+}
+
+// --- MONITOR (telemetria ao vivo) ---
+// Lê o segmento publicado por 'run --telemetry <nome>' uma vez por segundo e
+// mostra as taxas do intervalo. Termina no HALT ou quando o processo some.
+void monitor(const std::string &name, int samples)
+{
+    TelemetryReader reader;
+    if (!reader.open(name))
+    {
+        std::cerr << Color::RED << "Erro: telemetria '" << name << "' nao encontrada (rode: ./cpu_sim run ... --telemetry "
+                  << name << ")" << Color::RESET << std::endl;
+        return;
+    }
+    std::cout << Color::BLUE << Color::BOLD << "[MONITOR] " << name << " (pid " << reader.pid() << ")" << Color::RESET << std::endl;
+
+    TelemetrySnapshot last;
+    if (!reader.read(last))
+    {
+        std::cerr << Color::RED << "Erro: telemetria '" << name << "' inconsistente (publicador encerrado no meio da escrita)"
+                  << Color::RESET << std::endl;
+        return;
+    }
+    for (int printed = 0; samples <= 0 || printed < samples;)
+    {
+        sleep(1);
+        TelemetrySnapshot now;
+        bool consistent = reader.read(now);
+        bool gone = kill(reader.pid(), 0) != 0 && errno == ESRCH;
+        if (!consistent)
+        {
+            // Sequência ímpar parada: o publicador morreu no meio da cópia
+            if (gone)
+            {
+                std::cout << Color::YELLOW << "[MONITOR] Simulacao encerrada no meio de uma publicacao." << Color::RESET
+                          << std::endl;
+                return;
+            }
+            continue;
+        }
+        double seconds = (now.hostNanos - last.hostNanos) / 1e9;
+
+        if (printed % 20 == 0)
+            std::cout << Color::CYAN << "     instr   instr/s     IPC   hit%    MPKI   IRQ/s  lat.IRQ" << Color::RESET << std::endl;
+        uint64_t instructions = now.instructions - last.instructions;
+        uint64_t cycles = now.cycles - last.cycles;
+        uint64_t hits = now.cacheHits - last.cacheHits, misses = now.cacheMisses - last.cacheMisses;
+        uint64_t irqs = now.irqCount - last.irqCount;
+        std::cout << std::fixed << std::setw(10) << now.instructions << std::setprecision(0) << std::setw(10)
+                  << (seconds > 0 ? instructions / seconds : 0.0) << std::setprecision(3) << std::setw(8)
+                  << (cycles ? (double)instructions / cycles : 0.0) << std::setprecision(1) << std::setw(7)
+                  << (hits + misses ? (double)hits / (hits + misses) * 100.0 : 0.0) << std::setprecision(2) << std::setw(8)
+                  << (instructions ? (double)misses / instructions * 1000.0 : 0.0) << std::setprecision(1) << std::setw(8)
+                  << (seconds > 0 ? irqs / seconds : 0.0) << std::setw(9)
+                  << (irqs ? (double)(now.irqLatency - last.irqLatency) / irqs : 0.0) << std::endl;
+        printed++;
+        last = now;
+
+        if (now.finished || gone)
+        {
+            std::cout << Color::YELLOW << "[MONITOR] Simulacao " << (now.finished ? "terminou (HALT)" : "encerrada")
+                      << "." << Color::RESET << std::endl;
+            return;
+        }
+    }
+}
+
+// Junta histogramas exportados por várias execuções e mostra os percentis
+void histMerge(const std::vector<std::string> &inputs, const std::string &outputFile)
+{
+    Stats merged;
+    for (const std::string &input : inputs)
+    {
+        if (!merged.mergeHistograms(input))
+        {
+            std::cerr << Color::RED << "Erro: histograma invalido: " << input << Color::RESET << std::endl;
+            return;
+        }
+    }
+    std::cout << Color::BLUE << Color::BOLD << "[HIST] " << inputs.size() << " arquivos" << Color::RESET << std::endl;
+    merged.printLatencyReport();
+    if (!outputFile.empty() && merged.saveHistograms(outputFile))
+        std::cout << Color::YELLOW << "[INFO] Histogramas em " << outputFile << Color::RESET << std::endl;
 }
 
 int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        std::cout << "Uso:\n  ./cpu_sim build <fonte.txt> <saida.bin>\n  ./cpu_sim run <entrada.bin> [-q|--quiet]" << std::endl;
+        std::cout << "Uso:\n  ./cpu_sim build [-O] <fonte.txt> <saida.bin>\n  ./cpu_sim compile <fonte.txt> <saida.obj>\n  ./cpu_sim link <saida.bin> <a.txt|a.obj>... [-j N]\n  ./cpu_sim asm-bench <fonte.txt|N linhas>\n  ./cpu_sim bench [kernel.txt|dir]... [-n N] [--json saida.json]\n  ./cpu_sim analyze <entrada.bin> [--bound CABECALHO=N]... [--input teclas.txt]\n  ./cpu_sim run <entrada.bin> [-q|--quiet] [--trace <arq.trace>] [--trace-cat cache,irq]\n                 [--display sync|async|null] [--display-flush line|batch|exit]\n                 [--prefetch none|next[:N]|stride|stream]\n                 [--write-buffer N] [--victim N]\n                 [--pipeline [--no-forwarding]]\n                 [--bpred static|bimodal|gshare|tournament] [--btb N] [--ras N]\n                 [--ooo W [--rob N] [--lsq N]]\n                 [--mmu [--tlb SxW]] [--hist <arq.hist>] [--telemetry <nome>] [--quantum <ciclos>] [--clock-hz <hz|max>]\n                 [--debug [--time-travel <passos>] [--tt-budget <MB>]]\n  ./cpu_sim monitor <nome> [-n amostras]\n  ./cpu_sim hist-merge <a.hist>... [-o <saida.hist>]\n  ./cpu_sim decode <arq.trace>" << std::endl;
         return 0;
     }
 
@@ -157,11 +852,103 @@ int main(int argc, char *argv[])
     {
         build(argv[2], argv[3]);
     }
+    else if (command == "build" && argc == 5 && std::string(argv[2]) == "-O")
+    {
+        build(argv[3], argv[4], true);
+    }
+    else if (command == "compile" && argc == 4)
+    {
+        compile(argv[2], argv[3]);
+    }
+    else if (command == "link" && argc >= 4)
+    {
+        std::vector<std::string> inputs;
+        unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 3; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "-j" && i + 1 < argc)
+                jobs = (unsigned int)std::max(1, std::atoi(argv[++i]));
+            else
+                inputs.push_back(arg);
+        }
+        link(argv[2], inputs, jobs);
+    }
+    else if (command == "bench")
+    {
+        std::vector<std::string> inputs;
+        int reps = 5;
+        std::string jsonPath;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "-n" && i + 1 < argc)
+                reps = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--json" && i + 1 < argc)
+                jsonPath = argv[++i];
+            else
+                inputs.push_back(arg);
+        }
+        if (inputs.empty())
+            inputs.push_back("bench");
+        bench(inputs, reps, jsonPath);
+    }
+    else if (command == "analyze" && argc >= 3)
+    {
+        AnalyzerConfig config;
+        std::string inputFile;
+        for (int i = 3; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--bound" && i + 1 < argc)
+            {
+                std::string spec = argv[++i];
+                size_t eq = spec.find('=');
+                if (eq == std::string::npos)
+                {
+                    std::cerr << Color::RED << "Erro: use --bound CABECALHO=N" << Color::RESET << std::endl;
+                    return 1;
+                }
+                config.loopBounds[(Address)std::atol(spec.substr(0, eq).c_str())] = std::strtoull(spec.c_str() + eq + 1, nullptr, 10);
+            }
+            else if (arg == "--input" && i + 1 < argc)
+                inputFile = argv[++i];
+        }
+        analyze(argv[2], config, inputFile);
+    }
+    else if (command == "asm-bench" && argc == 3)
+    {
+        benchAssembler(argv[2]);
+    }
+    else if (command == "monitor" && argc >= 3)
+    {
+        int samples = 0;
+        if (argc >= 5 && std::string(argv[3]) == "-n")
+            samples = std::atoi(argv[4]);
+        monitor(argv[2], samples);
+    }
+    else if (command == "hist-merge" && argc >= 3)
+    {
+        std::vector<std::string> inputs;
+        std::string outputFile;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "-o" && i + 1 < argc)
+                outputFile = argv[++i];
+            else
+                inputs.push_back(arg);
+        }
+        histMerge(inputs, outputFile);
+    }
+    else if (command == "decode" && argc == 3)
+    {
+        Tracer::decodeFile(argv[2], std::cout);
+    }
     // Alterado para aceitar argumentos opcionais (argc >= 3)
     else if (command == "run" && argc >= 3)
     {
-        std::string firmwareFile;
-        bool quiet = false;
+        RunOptions options;
 
         // Parser simples de argumentos para o comando run
         for (int i = 2; i < argc; i++)
@@ -169,17 +956,130 @@ int main(int argc, char *argv[])
             std::string arg = argv[i];
             if (arg == "-q" || arg == "--quiet")
             {
-                quiet = true;
+                options.quiet = true;
+            }
+            else if (arg == "--trace" && i + 1 < argc)
+            {
+                options.traceFile = argv[++i];
+            }
+            else if (arg == "--debug")
+            {
+                options.debug = true;
+            }
+            else if (arg == "--time-travel" && i + 1 < argc)
+            {
+                options.timeTravelInterval = std::strtoull(argv[++i], nullptr, 10);
+                options.debug = true;
+            }
+            else if (arg == "--clock-hz" && i + 1 < argc)
+            {
+                if (!ClockPacer::parse(argv[++i], options.clockHz))
+                {
+                    std::cerr << Color::RED << "Erro: frequencia invalida: " << argv[i] << " (ex.: 1000, 2.5k, 4M, max)" << Color::RESET << std::endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--quantum" && i + 1 < argc)
+            {
+                options.quantum = std::strtoull(argv[++i], nullptr, 10);
+            }
+            else if (arg == "--tt-budget" && i + 1 < argc)
+            {
+                options.timeTravelBudgetMB = (size_t)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--telemetry" && i + 1 < argc)
+            {
+                options.telemetryName = argv[++i];
+            }
+            else if (arg == "--hist" && i + 1 < argc)
+            {
+                options.histogramFile = argv[++i];
+            }
+            else if (arg == "--trace-cat" && i + 1 < argc)
+            {
+                options.traceCategories = argv[++i];
+            }
+            else if (arg == "--display" && i + 1 < argc)
+            {
+                options.displayMode = argv[++i];
+            }
+            else if (arg == "--write-buffer" && i + 1 < argc)
+            {
+                options.machine.writeBufferDepth = (size_t)std::max(0, std::atoi(argv[++i]));
+            }
+            else if (arg == "--pipeline")
+            {
+                options.machine.pipeline = true;
+            }
+            else if (arg == "--no-forwarding")
+            {
+                options.machine.forwarding = false;
+            }
+            else if (arg == "--bpred" && i + 1 < argc)
+            {
+                options.machine.branchPredictor = argv[++i];
+            }
+            else if (arg == "--ooo" && i + 1 < argc)
+            {
+                options.machine.oooWidth = (unsigned int)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--rob" && i + 1 < argc)
+            {
+                options.machine.robSize = (size_t)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--lsq" && i + 1 < argc)
+            {
+                options.machine.lsqSize = (size_t)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--btb" && i + 1 < argc)
+            {
+                options.machine.btbEntries = (size_t)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--ras" && i + 1 < argc)
+            {
+                options.machine.rasDepth = (size_t)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--mmu")
+            {
+                options.machine.mmu = true;
+            }
+            else if (arg == "--tlb" && i + 1 < argc)
+            {
+                // Formato SxW, ex.: 8x2 (8 conjuntos, 2 vias)
+                std::string spec = argv[++i];
+                size_t x = spec.find('x');
+                options.machine.tlb.tlbSets = (size_t)std::max(1, std::atoi(spec.c_str()));
+                if (x != std::string::npos)
+                    options.machine.tlb.tlbWays = (size_t)std::max(1, std::atoi(spec.c_str() + x + 1));
+                options.machine.mmu = true;
+            }
+            else if (arg == "--victim" && i + 1 < argc)
+            {
+                options.machine.victimEntries = (size_t)std::max(0, std::atoi(argv[++i]));
+            }
+            else if (arg == "--prefetch" && i + 1 < argc)
+            {
+                options.machine.prefetch = argv[++i];
+            }
+            else if (arg == "--display-flush" && i + 1 < argc)
+            {
+                std::string policy = argv[++i];
+                if (policy == "batch")
+                    options.displayFlush = FlushPolicy::BATCH;
+                else if (policy == "exit")
+                    options.displayFlush = FlushPolicy::AT_EXIT;
+                else
+                    options.displayFlush = FlushPolicy::EVERY_LINE;
             }
             else
             {
-                firmwareFile = arg;
+                options.firmwareFile = arg;
             }
         }
 
-        if (!firmwareFile.empty())
+        if (!options.firmwareFile.empty())
         {
-            run(firmwareFile, quiet);
+            run(options);
         }
         else
         {